@@ -0,0 +1,217 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+template <typename T>
+size_t AllocationBytes(size_t n) {
+    if (n > std::numeric_limits<size_t>::max() / sizeof(T)) {
+        throw std::bad_array_new_length();
+    }
+    return n * sizeof(T);
+}
+
+template <typename Pointer>
+struct AllocationResult {
+    Pointer ptr;
+    size_t count;
+};
+
+// Allocator backed by malloc/realloc/free. Its reallocate hook lets Vector grow buffers of trivially
+// relocatable elements in place; glibc serves large blocks with mmap and grows them with mremap, so
+// even multi-gigabyte buffers are extended without copying.
+template <typename T>
+struct MallocAllocator {
+    static_assert(alignof(T) <= alignof(std::max_align_t), "malloc doesn't support over-aligned types");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    MallocAllocator() = default;
+
+    template <typename U>
+    MallocAllocator(const MallocAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return reallocate(nullptr, 0, n); }
+
+    // malloc rounds requests up to its size classes; the slack is handed out as extra capacity.
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        T* p = allocate(n);
+#if defined(__GLIBC__)
+        return {p, malloc_usable_size(p) / sizeof(T)};
+#else
+        return {p, n};
+#endif
+    }
+
+    void deallocate(T* p, size_t) noexcept { std::free(p); }
+
+    T* reallocate(T* p, size_t, size_t new_n) {
+        void* result = std::realloc(static_cast<void*>(p), AllocationBytes<T>(new_n));
+        if (result == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(result);
+    }
+
+    template <typename U>
+    bool operator==(const MallocAllocator<U>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const MallocAllocator<U>&) const noexcept {
+        return false;
+    }
+};
+
+// Allocates storage aligned to at least Alignment bytes (and never less than alignof(T)), e.g. to a cache
+// line or to the width of the widest SIMD register.
+template <typename T, size_t Alignment = alignof(T)>
+struct AlignedAllocator {
+    static constexpr size_t ALIGNMENT = std::max(Alignment, alignof(T));
+    static_assert((ALIGNMENT & (ALIGNMENT - 1)) == 0, "alignment must be a power of two");
+
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(AllocationBytes<T>(n), std::align_val_t{ALIGNMENT}));
+    }
+
+    void deallocate(T* p, size_t n) noexcept { ::operator delete(p, n * sizeof(T), std::align_val_t{ALIGNMENT}); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return false;
+    }
+};
+
+#if defined(__linux__)
+
+inline constexpr size_t HUGE_PAGE_SIZE = size_t{2} << 20;
+
+// Serves blocks of at least Threshold bytes with anonymous mappings aligned to and rounded up to huge
+// pages and advised with MADV_HUGEPAGE, which cuts TLB misses when scanning multi-gigabyte buffers.
+// Smaller blocks come from AlignedAllocator. Large blocks grow through mremap, which moves page tables
+// instead of copying data.
+template <typename T, size_t Alignment = alignof(T), size_t Threshold = HUGE_PAGE_SIZE>
+struct HugePageAllocator {
+    using value_type = T;
+    using is_always_equal = std::true_type;
+
+    template <typename U>
+    struct rebind {
+        using other = HugePageAllocator<U, Alignment, Threshold>;
+    };
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator(const HugePageAllocator<U, Alignment, Threshold>&) noexcept {}
+
+    T* allocate(size_t n) {
+        const size_t bytes = AllocationBytes<T>(n);
+        if (bytes < Threshold) {
+            return AlignedAllocator<T, Alignment>().allocate(n);
+        }
+        return static_cast<T*>(Map(MappingLength(bytes)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(T);
+        if (bytes < Threshold) {
+            AlignedAllocator<T, Alignment>().deallocate(p, n);
+        } else {
+            munmap(p, MappingLength(bytes));
+        }
+    }
+
+    T* reallocate(T* p, size_t old_n, size_t new_n) {
+        const size_t old_bytes = old_n * sizeof(T);
+        const size_t new_bytes = AllocationBytes<T>(new_n);
+
+        if (old_bytes >= Threshold && new_bytes >= Threshold) {
+            const size_t length = MappingLength(new_bytes);
+            void* result = mremap(p, MappingLength(old_bytes), length, MREMAP_MAYMOVE);
+            if (result == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            madvise(result, length, MADV_HUGEPAGE);
+            return static_cast<T*>(result);
+        }
+
+        T* result = allocate(new_n);
+        if (p != nullptr) {
+            std::memcpy(static_cast<void*>(result), static_cast<const void*>(p), std::min(old_bytes, new_bytes));
+            deallocate(p, old_n);
+        }
+        return result;
+    }
+
+    template <typename U>
+    bool operator==(const HugePageAllocator<U, Alignment, Threshold>&) const noexcept {
+        return true;
+    }
+
+    template <typename U>
+    bool operator!=(const HugePageAllocator<U, Alignment, Threshold>&) const noexcept {
+        return false;
+    }
+
+private:
+    static size_t MappingLength(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    // Maps an extra huge page and trims both ends so that the mapping starts on a huge page boundary
+    static void* Map(size_t length) {
+        void* p = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+
+        char* begin = static_cast<char*>(p);
+        char* aligned = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(begin) + HUGE_PAGE_SIZE - 1)
+                                                & ~(HUGE_PAGE_SIZE - 1));
+        if (aligned != begin) {
+            munmap(begin, aligned - begin);
+        }
+        if (const size_t tail = HUGE_PAGE_SIZE - (aligned - begin); tail != 0) {
+            munmap(aligned + length, tail);
+        }
+
+        // Only advice: without transparent huge pages the mapping is simply backed by regular pages
+        madvise(aligned, length, MADV_HUGEPAGE);
+        return aligned;
+    }
+};
+
+#endif
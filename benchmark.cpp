@@ -0,0 +1,377 @@
+#include "vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Record {
+    int64_t id = 0;
+    int64_t timestamp = 0;
+    double value = 0;
+    int64_t flags = 0;
+};
+
+static_assert(sizeof(Record) == 32);
+
+struct ThrowingMove {
+    ThrowingMove() = default;
+    explicit ThrowingMove(int id) : name(std::to_string(id)) {}
+    ThrowingMove(const ThrowingMove& other) = default;
+    ThrowingMove(ThrowingMove&& other) noexcept(false) : name(std::move(other.name)) {}
+    ThrowingMove& operator=(const ThrowingMove& other) = default;
+    ThrowingMove& operator=(ThrowingMove&& other) noexcept(false) {
+        name = std::move(other.name);
+        return *this;
+    }
+
+    std::string name;
+};
+
+template <typename T>
+T MakeValue(int i);
+
+template <>
+int MakeValue<int>(int i) {
+    return i;
+}
+
+template <>
+float MakeValue<float>(int i) {
+    return static_cast<float>(i);
+}
+
+template <>
+Record MakeValue<Record>(int i) {
+    return Record{i, i, static_cast<double>(i), 0};
+}
+
+template <>
+std::string MakeValue<std::string>(int i) {
+    // Longer than the small string buffer, so moves transfer heap ownership
+    return std::string(32, static_cast<char>('a' + i % 26));
+}
+
+template <>
+ThrowingMove MakeValue<ThrowingMove>(int i) {
+    return ThrowingMove(i);
+}
+
+// Uniform access to Vector and std::vector so that every benchmark runs against both containers
+template <typename T>
+void Append(Vector<T>& v, T value) {
+    v.PushBack(std::move(value));
+}
+
+template <typename T>
+void Append(std::vector<T>& v, T value) {
+    v.push_back(std::move(value));
+}
+
+template <typename T>
+void InsertAt(Vector<T>& v, size_t index, T value) {
+    v.Insert(v.begin() + index, std::move(value));
+}
+
+template <typename T>
+void InsertAt(std::vector<T>& v, size_t index, T value) {
+    v.insert(v.begin() + index, std::move(value));
+}
+
+template <typename T>
+void EraseAt(Vector<T>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename T>
+void EraseAt(std::vector<T>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename T>
+void Reserve(Vector<T>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename T>
+void Reserve(std::vector<T>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename T>
+size_t SizeOf(const Vector<T>& v) {
+    return v.Size();
+}
+
+template <typename T>
+size_t SizeOf(const std::vector<T>& v) {
+    return v.size();
+}
+
+template <typename Container>
+Container MakeFilled(int size) {
+    using T = typename Container::value_type;
+    Container v;
+    Reserve(v, size);
+    for (int i = 0; i < size; ++i) {
+        Append(v, MakeValue<T>(i));
+    }
+    return v;
+}
+
+enum class Where { FRONT, MIDDLE, BACK };
+
+size_t PositionOf(Where where, size_t size) {
+    switch (where) {
+        case Where::FRONT:
+            return 0;
+        case Where::MIDDLE:
+            return size / 2;
+        case Where::BACK:
+            return size;
+    }
+    return size;
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const int size = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Container v;
+        for (int i = 0; i < size; ++i) {
+            Append(v, MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename Container>
+void BM_PushBackReserved(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const int size = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Container v;
+        Reserve(v, size);
+        for (int i = 0; i < size; ++i) {
+            Append(v, MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void BM_UncheckedPushBack(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Vector<T> v;
+        v.Reserve(size);
+        for (int i = 0; i < size; ++i) {
+            v.UncheckedEmplaceBack(MakeValue<T>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename T>
+void BM_BackCursor(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        Vector<T> v;
+        {
+            typename Vector<T>::BackCursor cursor = v.ReserveBack(size);
+            for (int i = 0; i < size; ++i) {
+                cursor.EmplaceBack(MakeValue<T>(i));
+            }
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Allocation and deallocation of a buffer per iteration; compare builds with and without VECTOR_ENABLE_POOL
+template <typename Container>
+void BM_ShortLived(benchmark::State& state) {
+    const size_t size = static_cast<size_t>(state.range(0));
+    for (auto _ : state) {
+        Container v(size);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Measures relocation alone: the source is refilled outside the timed region
+template <typename Container>
+void BM_Reserve(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        Container v = MakeFilled<Container>(size);
+        state.ResumeTiming();
+        Reserve(v, size * 2);
+        benchmark::DoNotOptimize(v);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename Container, Where where>
+void BM_Insert(benchmark::State& state) {
+    using T = typename Container::value_type;
+    const int size = static_cast<int>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    for (auto _ : state) {
+        InsertAt(v, PositionOf(where, SizeOf(v)), MakeValue<T>(0));
+        EraseAt(v, PositionOf(where, SizeOf(v) - 1));
+    }
+    benchmark::DoNotOptimize(v);
+}
+
+template <typename Container>
+void BM_CopyAssign(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    const Container source = MakeFilled<Container>(size);
+    Container target = MakeFilled<Container>(size);
+    for (auto _ : state) {
+        target = source;
+        benchmark::DoNotOptimize(target);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    for (auto _ : state) {
+        for (auto& item : v) {
+            benchmark::DoNotOptimize(item);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Indexed access, the main cost of VECTOR_HARDENING bounds checks
+template <typename Container>
+void BM_Index(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    Container v = MakeFilled<Container>(size);
+    for (auto _ : state) {
+        for (size_t i = 0; i < SizeOf(v); ++i) {
+            benchmark::DoNotOptimize(v[i]);
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+}
+
+// Vectorized member scans against the generic algorithms over the same buffer
+template <typename T>
+void BM_SumGeneric(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::accumulate(v.begin(), v.end(), T{}));
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+template <typename T>
+void BM_SumMember(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v.Sum());
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+template <typename T>
+void BM_FindGeneric(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(std::find(v.begin(), v.end(), T{-1}));
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+template <typename T>
+void BM_FindMember(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v.Find(T{-1}));
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+template <typename T>
+void BM_MaxGeneric(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(*std::max_element(v.begin(), v.end()));
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+template <typename T>
+void BM_MaxMember(benchmark::State& state) {
+    const Vector<T> v = MakeFilled<Vector<T>>(static_cast<int>(state.range(0)));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v.Max());
+    }
+    state.SetItemsProcessed(state.iterations() * v.Size());
+}
+
+}  // namespace
+
+#define VECTOR_BENCHMARK(bench, T)                                                        \
+    BENCHMARK_TEMPLATE(bench, std::vector<T>)->RangeMultiplier(16)->Range(16, 1 << 16); \
+    BENCHMARK_TEMPLATE(bench, Vector<T>)->RangeMultiplier(16)->Range(16, 1 << 16)
+
+#define VECTOR_INSERT_BENCHMARK(T, where)                                                          \
+    BENCHMARK_TEMPLATE(BM_Insert, std::vector<T>, where)->RangeMultiplier(16)->Range(16, 1 << 16); \
+    BENCHMARK_TEMPLATE(BM_Insert, Vector<T>, where)->RangeMultiplier(16)->Range(16, 1 << 16)
+
+#define VECTOR_BENCHMARKS_FOR(T)               \
+    VECTOR_BENCHMARK(BM_PushBack, T);          \
+    VECTOR_BENCHMARK(BM_PushBackReserved, T);  \
+    VECTOR_BENCHMARK(BM_Reserve, T);           \
+    VECTOR_INSERT_BENCHMARK(T, Where::FRONT);  \
+    VECTOR_INSERT_BENCHMARK(T, Where::MIDDLE); \
+    VECTOR_INSERT_BENCHMARK(T, Where::BACK);   \
+    VECTOR_BENCHMARK(BM_CopyAssign, T);        \
+    VECTOR_BENCHMARK(BM_Iterate, T);           \
+    VECTOR_BENCHMARK(BM_Index, T);             \
+    VECTOR_BENCHMARK(BM_ShortLived, T)
+
+VECTOR_BENCHMARKS_FOR(int);
+VECTOR_BENCHMARKS_FOR(Record);
+VECTOR_BENCHMARKS_FOR(std::string);
+VECTOR_BENCHMARKS_FOR(ThrowingMove);
+
+#define SCAN_BENCHMARK(bench, T) BENCHMARK_TEMPLATE(bench, T)->RangeMultiplier(16)->Range(16, 1 << 20)
+
+#define SCAN_BENCHMARKS_FOR(T)          \
+    SCAN_BENCHMARK(BM_SumGeneric, T);  \
+    SCAN_BENCHMARK(BM_SumMember, T);   \
+    SCAN_BENCHMARK(BM_FindGeneric, T); \
+    SCAN_BENCHMARK(BM_FindMember, T);  \
+    SCAN_BENCHMARK(BM_MaxGeneric, T);  \
+    SCAN_BENCHMARK(BM_MaxMember, T)
+
+SCAN_BENCHMARKS_FOR(int);
+SCAN_BENCHMARKS_FOR(float);
+
+// Compare with BM_PushBackReserved<Vector<T>>
+#define APPEND_BENCHMARKS_FOR(T)                                                          \
+    BENCHMARK_TEMPLATE(BM_UncheckedPushBack, T)->RangeMultiplier(16)->Range(16, 1 << 16); \
+    BENCHMARK_TEMPLATE(BM_BackCursor, T)->RangeMultiplier(16)->Range(16, 1 << 16)
+
+APPEND_BENCHMARKS_FOR(int);
+APPEND_BENCHMARKS_FOR(Record);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,219 @@
+#pragma once
+#include "vector.h"
+
+#include <iterator>
+
+// Sequence stored in fixed-size RawMemory chunks. Growing adds a chunk instead of relocating, so elements
+// never move and pointers and references to them stay valid until the element is removed. Indexing is a
+// shift and a mask, as ChunkSize is a power of two.
+template <typename T, size_t ChunkSize = 256, typename Alloc = std::allocator<T>>
+class ChunkedVector {
+    static_assert(ChunkSize != 0 && (ChunkSize & (ChunkSize - 1)) == 0, "chunk size must be a power of two");
+
+    using Chunk = RawMemory<T, Alloc>;
+    using ChunkAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Chunk>;
+
+    template <bool IsConst>
+    class BasicIterator {
+        using Container = std::conditional_t<IsConst, const ChunkedVector, ChunkedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<IsConst, const T*, T*>;
+        using reference = std::conditional_t<IsConst, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(Container* container, size_t index) noexcept : container_(container), index_(index) {}
+
+        operator BasicIterator<true>() const noexcept { return {container_, index_}; }
+
+        reference operator*() const noexcept { return (*container_)[index_]; }
+
+        pointer operator->() const noexcept { return &(*container_)[index_]; }
+
+        reference operator[](difference_type offset) const noexcept { return (*container_)[index_ + offset]; }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept { return {container_, index_++}; }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept { return {container_, index_--}; }
+
+        BasicIterator& operator+=(difference_type offset) noexcept {
+            index_ += offset;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type offset) noexcept {
+            index_ -= offset;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type offset) noexcept { return it += offset; }
+
+        friend BasicIterator operator+(difference_type offset, BasicIterator it) noexcept { return it += offset; }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type offset) noexcept { return it -= offset; }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend bool operator!=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ != rhs.index_;
+        }
+
+        friend bool operator<(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ < rhs.index_;
+        }
+
+        friend bool operator>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept { return rhs < lhs; }
+
+        friend bool operator<=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept { return !(rhs < lhs); }
+
+        friend bool operator>=(const BasicIterator& lhs, const BasicIterator& rhs) noexcept { return !(lhs < rhs); }
+
+    private:
+        Container* container_ = nullptr;
+        size_t index_ = 0;
+    };
+
+public:
+    using value_type = T;
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+    using allocator_type = Alloc;
+
+    static constexpr size_t CHUNK_SIZE = ChunkSize;
+
+    ChunkedVector() = default;
+
+    explicit ChunkedVector(const Alloc& alloc) : alloc_(alloc), chunks_(ChunkAlloc(alloc)) {}
+
+    ChunkedVector(const ChunkedVector& other)
+        : ChunkedVector(std::allocator_traits<Alloc>::select_on_container_copy_construction(other.alloc_)) {
+        Reserve(other.size_);
+        for (const T& value : other) {
+            EmplaceBack(value);
+        }
+    }
+
+    ChunkedVector(ChunkedVector&& other) noexcept
+        : alloc_(other.alloc_), chunks_(std::move(other.chunks_)), size_(std::exchange(other.size_, 0)) {}
+
+    ChunkedVector& operator=(const ChunkedVector& other) {
+        if (this != &other) {
+            ChunkedVector temp(other);
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    ChunkedVector& operator=(ChunkedVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~ChunkedVector() { Clear(); }
+
+    iterator begin() noexcept { return {this, 0}; }
+
+    iterator end() noexcept { return {this, size_}; }
+
+    const_iterator begin() const noexcept { return {this, 0}; }
+
+    const_iterator end() const noexcept { return {this, size_}; }
+
+    const_iterator cbegin() const noexcept { return begin(); }
+
+    const_iterator cend() const noexcept { return end(); }
+
+    size_t Size() const noexcept { return size_; }
+
+    size_t Capacity() const noexcept { return chunks_.Size() * ChunkSize; }
+
+    // Allocates chunks up front; existing elements stay where they are
+    void Reserve(size_t new_capacity) {
+        const size_t chunk_count = (new_capacity + ChunkSize - 1) / ChunkSize;
+
+        chunks_.Reserve(chunk_count);
+        while (chunks_.Size() < chunk_count) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+    }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            chunks_.EmplaceBack(ChunkSize, alloc_);
+        }
+
+        T* slot = &(*this)[size_];
+        new (slot) T(std::forward<Args>(args)...);
+        ++size_;
+
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(&(*this)[size_]);
+    }
+
+    // Destroys all elements and keeps the chunks for reuse
+    void Clear() noexcept {
+        for (size_t chunk = 0; chunk * ChunkSize < size_; ++chunk) {
+            std::destroy_n(chunks_[chunk].GetAddress(), std::min(ChunkSize, size_ - chunk * ChunkSize));
+        }
+        size_ = 0;
+    }
+
+    // Frees chunks that hold no elements
+    void ShrinkToFit() {
+        const size_t chunk_count = (size_ + ChunkSize - 1) / ChunkSize;
+        while (chunks_.Size() > chunk_count) {
+            chunks_.PopBack();
+        }
+    }
+
+    void Swap(ChunkedVector& other) noexcept {
+        chunks_.Swap(other.chunks_);
+        std::swap(size_, other.size_);
+        if constexpr (std::allocator_traits<Alloc>::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(alloc_, other.alloc_);
+        }
+    }
+
+    Alloc GetAllocator() const noexcept { return alloc_; }
+
+    const T& operator[](size_t index) const noexcept { return chunks_[index / ChunkSize][index % ChunkSize]; }
+
+    T& operator[](size_t index) noexcept { return chunks_[index / ChunkSize][index % ChunkSize]; }
+
+private:
+    Alloc alloc_;
+    Vector<Chunk, ChunkAlloc> chunks_;
+    size_t size_ = 0;
+};
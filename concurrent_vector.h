@@ -0,0 +1,172 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Append-only vector for many producer threads. EmplaceBack claims a slot with a single fetch_add on the size
+// cursor and constructs the element in place; storage is a fixed table of segments whose sizes double, so
+// growth never moves elements and never blocks other producers. Segment k holds FirstSegmentSize << k
+// elements, which keeps indexing O(1).
+//
+// Size() counts claimed slots, including ones whose element is still being built. An element may be read
+// once it is published: after its EmplaceBack returned in a thread that happens-before the reader, or once
+// IsPublished returned true. A slot whose segment allocation or construction threw stays unpublished.
+// Destruction and Clear must not run concurrently with anything else.
+template <typename T, size_t FirstSegmentSize = 64, typename Alloc = std::allocator<T>>
+class ConcurrentVector {
+    static_assert(FirstSegmentSize != 0 && (FirstSegmentSize & (FirstSegmentSize - 1)) == 0,
+                  "first segment size must be a power of two");
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<bool> published{false};
+
+        T* Get() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+
+        const T* Get() const noexcept { return std::launder(reinterpret_cast<const T*>(storage)); }
+    };
+
+    using SlotAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<Slot>;
+    using SlotAllocTraits = std::allocator_traits<SlotAlloc>;
+
+    static constexpr size_t MAX_SEGMENTS = 64;
+
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    ConcurrentVector() = default;
+
+    explicit ConcurrentVector(const Alloc& alloc) : alloc_(alloc) {}
+
+    ConcurrentVector(const ConcurrentVector&) = delete;
+
+    ConcurrentVector& operator=(const ConcurrentVector&) = delete;
+
+    ~ConcurrentVector() {
+        Clear();
+        for (size_t k = 0; k < MAX_SEGMENTS; ++k) {
+            if (Slot* segment = GetSegment(k)) {
+                FreeSegment(segment, SegmentSize(k));
+            }
+        }
+    }
+
+    // Wait-free
+    size_t Size() const noexcept { return size_.load(std::memory_order_acquire); }
+
+    // Safe to call concurrently with EmplaceBack
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        const size_t index = size_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = EnsureSegment(SegmentOf(index))[OffsetOf(index)];
+
+        new (slot.storage) T(std::forward<Args>(args)...);
+        slot.published.store(true, std::memory_order_release);
+
+        return *slot.Get();
+    }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    // Whether element `index` < Size() is fully constructed and may be read
+    bool IsPublished(size_t index) const noexcept {
+        const Slot* segment = GetSegment(SegmentOf(index));
+        return segment != nullptr && segment[OffsetOf(index)].published.load(std::memory_order_acquire);
+    }
+
+    // Allocates the segments for the first `capacity` elements so that producers don't have to
+    void Reserve(size_t capacity) {
+        if (capacity != 0) {
+            for (size_t k = 0; k <= SegmentOf(capacity - 1); ++k) {
+                EnsureSegment(k);
+            }
+        }
+    }
+
+    // Destroys all elements and keeps the segments for reuse. Slots claimed by an EmplaceBack whose segment
+    // allocation threw may have no segment at all, so only installed segments are walked.
+    void Clear() noexcept {
+        const size_t size = size_.load(std::memory_order_relaxed);
+        size_t first = 0;
+        for (size_t k = 0; k < MAX_SEGMENTS && first < size; first += SegmentSize(k), ++k) {
+            Slot* segment = GetSegment(k);
+            if (segment == nullptr) {
+                continue;
+            }
+            const size_t count = std::min(SegmentSize(k), size - first);
+            for (size_t offset = 0; offset < count; ++offset) {
+                Slot& slot = segment[offset];
+                if (slot.published.load(std::memory_order_relaxed)) {
+                    std::destroy_at(slot.Get());
+                    slot.published.store(false, std::memory_order_relaxed);
+                }
+            }
+        }
+        size_.store(0, std::memory_order_relaxed);
+    }
+
+    // The element must be published
+    const T& operator[](size_t index) const noexcept {
+        return *GetSegment(SegmentOf(index))[OffsetOf(index)].Get();
+    }
+
+    T& operator[](size_t index) noexcept { return *GetSegment(SegmentOf(index))[OffsetOf(index)].Get(); }
+
+private:
+    static constexpr size_t SegmentSize(size_t k) noexcept { return FirstSegmentSize << k; }
+
+    // Segment k starts at element FirstSegmentSize * (2^k - 1)
+    static size_t SegmentOf(size_t index) noexcept {
+        const unsigned long long scaled = index / FirstSegmentSize + 1;
+        return static_cast<size_t>(63 - __builtin_clzll(scaled));
+    }
+
+    static size_t OffsetOf(size_t index) noexcept {
+        return index - FirstSegmentSize * ((size_t{1} << SegmentOf(index)) - 1);
+    }
+
+    Slot* GetSegment(size_t k) const noexcept { return segments_[k].load(std::memory_order_acquire); }
+
+    // Producers that find the same segment missing race to install one; the losers free theirs
+    Slot* EnsureSegment(size_t k) {
+        Slot* segment = GetSegment(k);
+        if (segment != nullptr) {
+            return segment;
+        }
+
+        Slot* fresh = AllocateSegment(SegmentSize(k));
+        if (segments_[k].compare_exchange_strong(segment, fresh, std::memory_order_acq_rel,
+                                                 std::memory_order_acquire)) {
+            return fresh;
+        }
+
+        FreeSegment(fresh, SegmentSize(k));
+        return segment;
+    }
+
+    Slot* AllocateSegment(size_t n) {
+        SlotAlloc alloc(alloc_);
+        Slot* segment = SlotAllocTraits::allocate(alloc, n);
+        std::uninitialized_default_construct_n(segment, n);
+        return segment;
+    }
+
+    void FreeSegment(Slot* segment, size_t n) noexcept {
+        SlotAlloc alloc(alloc_);
+        std::destroy_n(segment, n);
+        SlotAllocTraits::deallocate(alloc, segment, n);
+    }
+
+private:
+    Alloc alloc_;
+    std::atomic<size_t> size_{0};
+    std::atomic<Slot*> segments_[MAX_SEGMENTS] = {};
+};
@@ -0,0 +1,312 @@
+#pragma once
+#include "vector.h"
+
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+// Position of the first element of the sorted range [first, first + n) that isn't less than key. The loop
+// halves the range with a conditional move instead of a branch, so lookups don't pay for mispredictions and
+// run the same number of iterations for every key.
+template <typename T, typename K, typename Compare>
+const T* BranchlessLowerBound(const T* first, size_t n, const K& key, const Compare& comp) {
+    if (n == 0) {
+        return first;
+    }
+
+    while (n > 1) {
+        const size_t half = n / 2;
+        first = comp(first[half], key) ? first + half : first;
+        n -= half;
+    }
+    return first + comp(*first, key);
+}
+
+// Sorted set stored contiguously in a Vector. Lookups are binary searches over one array, and inserting a
+// batch sorts it and merges it in with a single reallocation.
+template <typename Key, typename Compare = std::less<Key>>
+class FlatSet {
+public:
+    using value_type = Key;
+    using iterator = const Key*;
+    using const_iterator = const Key*;
+
+    FlatSet() = default;
+
+    explicit FlatSet(const Compare& comp) : comp_(comp) {}
+
+    // Sorts the range once and drops duplicates, keeping the first of equal keys
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    FlatSet(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+        keys_.Insert(keys_.end(), first, last);
+        SortUnique(keys_);
+    }
+
+    const_iterator begin() const noexcept { return keys_.begin(); }
+
+    const_iterator end() const noexcept { return keys_.end(); }
+
+    size_t Size() const noexcept { return keys_.Size(); }
+
+    void Reserve(size_t capacity) { keys_.Reserve(capacity); }
+
+    void Clear() noexcept { keys_.Clear(); }
+
+    const_iterator LowerBound(const Key& key) const {
+        return BranchlessLowerBound(keys_.Data(), Size(), key, comp_);
+    }
+
+    const_iterator Find(const Key& key) const {
+        const_iterator it = LowerBound(key);
+        return it != end() && !comp_(key, *it) ? it : end();
+    }
+
+    bool Contains(const Key& key) const { return Find(key) != end(); }
+
+    // Returns false if the key is already present
+    template <typename K>
+    bool Insert(K&& key) {
+        const_iterator it = LowerBound(key);
+        if (it != end() && !comp_(key, *it)) {
+            return false;
+        }
+        keys_.Emplace(keys_.begin() + (it - begin()), std::forward<K>(key));
+        return true;
+    }
+
+    // Inserts the keys that aren't present yet and returns how many there were. The batch is appended with
+    // the range Insert and merged in place. If that throws, the set is left empty.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t Insert(InputIt first, InputIt last) {
+        Vector<Key> batch;
+        batch.Insert(batch.end(), first, last);
+        SortUnique(batch);
+        batch.EraseIf([this](const Key& key) { return Contains(key); });
+
+        const size_t old_size = Size();
+        keys_.Insert(keys_.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        try {
+            std::inplace_merge(keys_.begin(), keys_.begin() + old_size, keys_.end(), comp_);
+        } catch (...) {
+            keys_.Clear();
+            throw;
+        }
+        return batch.Size();
+    }
+
+    // Returns false if the key isn't present
+    bool Erase(const Key& key) {
+        const_iterator it = Find(key);
+        if (it == end()) {
+            return false;
+        }
+        keys_.Erase(keys_.begin() + (it - begin()));
+        return true;
+    }
+
+    const Vector<Key>& Keys() const noexcept { return keys_; }
+
+private:
+    void SortUnique(Vector<Key>& keys) const {
+        std::stable_sort(keys.begin(), keys.end(), comp_);
+        const auto equal = [this](const Key& lhs, const Key& rhs) { return !comp_(lhs, rhs); };
+        keys.Erase(std::unique(keys.begin(), keys.end(), equal), keys.end());
+    }
+
+private:
+    Vector<Key> keys_;
+    Compare comp_;
+};
+
+// Sorted map with keys and values in separate Vectors, so lookups search a dense array of keys and touch a
+// value only once it has been found. Element i of Keys() is mapped to element i of Values().
+template <typename Key, typename Value, typename Compare = std::less<Key>>
+class FlatMap {
+public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp) : comp_(comp) {}
+
+    // Sorts the pairs once and drops duplicate keys, keeping the first pair of each
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    FlatMap(InputIt first, InputIt last, const Compare& comp = Compare()) : comp_(comp) {
+        Insert(first, last);
+    }
+
+    size_t Size() const noexcept { return keys_.Size(); }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    // Index of the key, or Size() if it isn't present
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerBound(key);
+        return index != Size() && !comp_(key, keys_[index]) ? index : Size();
+    }
+
+    bool Contains(const Key& key) const { return IndexOf(key) != Size(); }
+
+    // Returns nullptr if the key isn't present
+    Value* Find(const Key& key) {
+        const size_t index = IndexOf(key);
+        return index != Size() ? &values_[index] : nullptr;
+    }
+
+    const Value* Find(const Key& key) const {
+        const size_t index = IndexOf(key);
+        return index != Size() ? &values_[index] : nullptr;
+    }
+
+    Value& At(const Key& key) { return values_[CheckedIndexOf(key)]; }
+
+    const Value& At(const Key& key) const { return values_[CheckedIndexOf(key)]; }
+
+    // Inserts a value-initialized value if the key isn't present
+    Value& operator[](const Key& key) { return *TryEmplace(key).first; }
+
+    // Returns the value mapped to the key and whether it was inserted, as std::map::try_emplace does. Nothing
+    // is built from args if the key is already present.
+    template <typename K, typename... Args>
+    std::pair<Value*, bool> TryEmplace(K&& key, Args&&... args) {
+        const size_t index = LowerBound(key);
+        if (index != Size() && !comp_(key, keys_[index])) {
+            return {&values_[index], false};
+        }
+
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Emplace(keys_.begin() + index, std::forward<K>(key));
+        } catch (...) {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {&values_[index], true};
+    }
+
+    // Returns false, leaving the map unchanged, if the key is already present
+    bool Insert(value_type pair) { return TryEmplace(std::move(pair.first), std::move(pair.second)).second; }
+
+    template <typename K, typename V>
+    bool InsertOrAssign(K&& key, V&& value) {
+        auto [existing, inserted] = TryEmplace(std::forward<K>(key), std::forward<V>(value));
+        if (!inserted) {
+            *existing = std::forward<V>(value);
+        }
+        return inserted;
+    }
+
+    // Inserts the pairs whose keys aren't present yet and returns how many there were. The batch is appended
+    // with the range Insert and merged in place. If that throws, the map is left empty.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    size_t Insert(InputIt first, InputIt last) {
+        Vector<value_type> pairs;
+        pairs.Insert(pairs.end(), first, last);
+
+        const auto less = [this](const value_type& lhs, const value_type& rhs) {
+            return comp_(lhs.first, rhs.first);
+        };
+        const auto equal = [this](const value_type& lhs, const value_type& rhs) {
+            return !comp_(lhs.first, rhs.first);
+        };
+        std::stable_sort(pairs.begin(), pairs.end(), less);
+        pairs.Erase(std::unique(pairs.begin(), pairs.end(), equal), pairs.end());
+        pairs.EraseIf([this](const value_type& pair) { return Contains(pair.first); });
+
+        Vector<Key> batch_keys;
+        Vector<Value> batch_values;
+        batch_keys.Reserve(pairs.Size());
+        batch_values.Reserve(pairs.Size());
+        for (value_type& pair : pairs) {
+            batch_keys.EmplaceBack(std::move(pair.first));
+            batch_values.EmplaceBack(std::move(pair.second));
+        }
+
+        const size_t old_size = Size();
+        try {
+            keys_.Insert(keys_.end(), std::make_move_iterator(batch_keys.begin()),
+                         std::make_move_iterator(batch_keys.end()));
+            values_.Insert(values_.end(), std::make_move_iterator(batch_values.begin()),
+                           std::make_move_iterator(batch_values.end()));
+            MergeTail(old_size);
+        } catch (...) {
+            Clear();
+            throw;
+        }
+        return pairs.Size();
+    }
+
+    // Returns false if the key isn't present
+    bool Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == Size()) {
+            return false;
+        }
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+        return true;
+    }
+
+    const Vector<Key>& Keys() const noexcept { return keys_; }
+
+    const Vector<Value>& Values() const noexcept { return values_; }
+
+    Vector<Value>& Values() noexcept { return values_; }
+
+private:
+    size_t CheckedIndexOf(const Key& key) const {
+        const size_t index = IndexOf(key);
+        if (index == Size()) {
+            throw std::out_of_range("key is not in the map");
+        }
+        return index;
+    }
+
+    size_t LowerBound(const Key& key) const {
+        return BranchlessLowerBound(keys_.Data(), Size(), key, comp_) - keys_.Data();
+    }
+
+    // Merges the sorted rows [0, mid) and [mid, Size()): the merged order is computed over indices and then
+    // applied to both columns by following the cycles of the permutation
+    void MergeTail(size_t mid) {
+        Vector<size_t> order(Size());
+        std::iota(order.begin(), order.end(), size_t{0});
+        std::inplace_merge(order.begin(), order.begin() + mid, order.end(),
+                           [this](size_t lhs, size_t rhs) { return comp_(keys_[lhs], keys_[rhs]); });
+
+        for (size_t start = 0; start < order.Size(); ++start) {
+            if (order[start] == start) {
+                continue;
+            }
+
+            Key key = std::move(keys_[start]);
+            Value value = std::move(values_[start]);
+            size_t hole = start;
+            while (order[hole] != start) {
+                const size_t next = order[hole];
+                keys_[hole] = std::move(keys_[next]);
+                values_[hole] = std::move(values_[next]);
+                order[hole] = hole;
+                hole = next;
+            }
+            keys_[hole] = std::move(key);
+            values_[hole] = std::move(value);
+            order[hole] = hole;
+        }
+    }
+
+private:
+    Vector<Key> keys_;
+    Vector<Value> values_;
+    Compare comp_;
+};
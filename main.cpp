@@ -1,8 +1,26 @@
 #include "vector.h"
 
+#include "allocators.h"
+#include "chunked_vector.h"
+#include "concurrent_vector.h"
+#include "flat_map.h"
+#include "mapped_vector.h"
+#include "shared_vector.h"
+#include "small_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "vector_io.h"
+#include "vector_parallel.h"
+
+#include <array>
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <numeric>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 
 namespace {
 
@@ -98,8 +116,157 @@ struct Obj {
     static inline int num_destroyed = 0;
 };
 
+struct RelocatableObj {
+    RelocatableObj() = default;
+
+    explicit RelocatableObj(int id) : id(std::make_unique<int>(id)) {}
+
+    RelocatableObj(RelocatableObj&& other) noexcept : id(std::move(other.id)) { ++num_moved; }
+
+    RelocatableObj& operator=(RelocatableObj&& other) = default;
+
+    ~RelocatableObj() { ++num_destroyed; }
+
+    static void ResetCounters() {
+        num_moved = 0;
+        num_destroyed = 0;
+    }
+
+    std::unique_ptr<int> id;
+
+    static inline int num_moved = 0;
+    static inline int num_destroyed = 0;
+};
+
+// Thread-safe counterpart of Obj's counters for the parallel algorithms
+struct AtomicObj {
+    AtomicObj() {
+        if (throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+
+    AtomicObj(const AtomicObj&) {
+        if (throw_countdown.fetch_sub(1) == 1) {
+            throw std::runtime_error("Oops");
+        }
+        ++alive;
+    }
+
+    ~AtomicObj() { --alive; }
+
+    static inline std::atomic<int> alive = 0;
+    static inline std::atomic<int> throw_countdown = 0;
+};
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    CountingAllocator() = default;
+
+    explicit CountingAllocator(int* allocations) : allocations(allocations) {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) noexcept : allocations(other.allocations) {}
+
+    T* allocate(size_t n) {
+        ++*allocations;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        --*allocations;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const CountingAllocator<U>& other) const noexcept {
+        return allocations == other.allocations;
+    }
+
+    template <typename U>
+    bool operator!=(const CountingAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+    int* allocations = nullptr;
+};
+
+// Throws bad_alloc once the budget of allocations is spent
+template <typename T>
+struct FailingAllocator {
+    using value_type = T;
+
+    explicit FailingAllocator(int* budget) : budget(budget) {}
+
+    template <typename U>
+    FailingAllocator(const FailingAllocator<U>& other) noexcept : budget(other.budget) {}
+
+    T* allocate(size_t n) {
+        if (*budget == 0) {
+            throw std::bad_alloc();
+        }
+        --*budget;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, size_t n) noexcept { std::allocator<T>{}.deallocate(p, n); }
+
+    template <typename U>
+    bool operator==(const FailingAllocator<U>& other) const noexcept {
+        return budget == other.budget;
+    }
+
+    template <typename U>
+    bool operator!=(const FailingAllocator<U>& other) const noexcept {
+        return !(*this == other);
+    }
+
+    int* budget = nullptr;
+};
+
+template <typename T>
+struct PageAllocator : std::allocator<T> {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = PageAllocator<U>;
+    };
+
+    static constexpr size_t PAGE = 16;
+
+    AllocationResult<T*> allocate_at_least(size_t n) {
+        const size_t count = (n + PAGE - 1) / PAGE * PAGE;
+        return {this->allocate(count), count};
+    }
+};
+
+class CountingResource : public std::pmr::memory_resource {
+public:
+    int allocations = 0;
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        --allocations;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+};
+
 }  // namespace
 
+template <>
+struct IsTriviallyRelocatable<RelocatableObj> : std::true_type {};
+
 void Test1() {
     Obj::ResetCounters();
     const size_t SIZE = 100500;
@@ -380,6 +547,1689 @@ void Test5() {
     }
 }
 
+void Test6() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        int allocations = 0;
+        {
+            CountingAllocator<Obj> alloc(&allocations);
+            Vector<Obj, CountingAllocator<Obj>> v(SIZE, alloc);
+            assert(allocations == 1);
+            v.PushBack(Obj{});
+            assert(allocations == 1);
+            assert(v.Capacity() == SIZE * 2);
+
+            auto v_copy(v);
+            assert(allocations == 2);
+            assert(v_copy.GetAllocator() == alloc);
+
+            auto v_moved(std::move(v));
+            assert(allocations == 2);
+            assert(v.Size() == 0);
+            assert(v_moved.Size() == SIZE + 1);
+        }
+        assert(allocations == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        CountingResource first;
+        CountingResource second;
+        {
+            pmr::Vector<int> v(&first);
+            for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+                v.PushBack(i);
+            }
+            assert(first.allocations == 1);
+
+            pmr::Vector<int> other(SIZE / 2, &second);
+            other = v;
+            assert(first.allocations == 1);
+            assert(second.allocations == 1);
+            assert(other.Size() == SIZE && other[SIZE - 1] == static_cast<int>(SIZE) - 1);
+
+            pmr::Vector<int> third(&second);
+            third = std::move(v);
+            assert(third.GetAllocator().resource() == &second);
+            assert(third.Size() == SIZE);
+        }
+        assert(first.allocations == 0);
+        assert(second.allocations == 0);
+    }
+}
+
+void Test7() {
+    const size_t SIZE = 128;
+    static_assert(IsTriviallyRelocatable<int>::value);
+    static_assert(IsTriviallyRelocatable<std::unique_ptr<int>>::value);
+    static_assert(!IsTriviallyRelocatable<Obj>::value);
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Size() == v.Capacity());
+        v.Emplace(v.begin() + SIZE / 2, -1);
+        v.Reserve(SIZE * 4);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(v.Size() == SIZE + 1);
+        assert(*v[0].id == 0);
+        assert(*v[SIZE / 2].id == -1);
+        assert(*v[SIZE].id == static_cast<int>(SIZE) - 1);
+    }
+    assert(RelocatableObj::num_destroyed == static_cast<int>(SIZE) + 1);
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Emplace(v.begin() + 1, std::make_unique<int>(-1));
+        assert(*v[1] == -1);
+        assert(*v[SIZE] == static_cast<int>(SIZE) - 1);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v[SIZE - 1].throw_on_copy = true;
+        // Obj's noexcept move is used, so growth never reaches the throwing copy
+        v.Emplace(v.begin() + SIZE / 2, 1);
+        assert(v.Size() == SIZE + 1);
+        assert(Obj::num_copied == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test8() {
+    const size_t SIZE = 1000;
+    {
+        Vector<int, MallocAllocator<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == 1024);
+        v.Reserve(SIZE * 8);
+        assert(v.Capacity() == SIZE * 8);
+
+        v.Resize(v.Capacity());
+        v.Emplace(v.begin() + 1, v[SIZE - 1]);
+        assert(v[0] == 0 && v[1] == static_cast<int>(SIZE) - 1 && v[2] == 1);
+        assert(v[SIZE] == static_cast<int>(SIZE) - 1);
+
+        v.Resize(v.Capacity());
+        v.PushBack(v[1]);
+        assert(v[v.Size() - 1] == static_cast<int>(SIZE) - 1);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj, MallocAllocator<RelocatableObj>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(i);
+        }
+        v.Resize(v.Capacity());
+        v.Emplace(v.begin(), -1);
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(*v[0].id == -1);
+        assert(*v[SIZE].id == static_cast<int>(SIZE) - 1);
+    }
+    assert(RelocatableObj::num_destroyed == 1025);
+}
+
+void Test9() {
+    static_assert(DoublingGrowth::NextCapacity(0) == 1);
+    static_assert(DoublingGrowth::NextCapacity(5) == 10);
+    static_assert(OneAndHalfGrowth::NextCapacity(0) == 1);
+    static_assert(OneAndHalfGrowth::NextCapacity(1) == 2);
+    static_assert(OneAndHalfGrowth::NextCapacity(10) == 15);
+    static_assert(MinCapacityGrowth<8>::NextCapacity(0) == 8);
+    static_assert(MinCapacityGrowth<8>::NextCapacity(8) == 16);
+    {
+        Vector<int, std::allocator<int>, OneAndHalfGrowth> v;
+        const size_t expected[] = {1, 2, 3, 4, 6, 9, 13, 19};
+        for (size_t capacity : expected) {
+            v.PushBack(0);
+            v.Resize(v.Capacity());
+            assert(v.Capacity() == capacity);
+        }
+        v.Emplace(v.begin(), 1);
+        assert(v.Capacity() == 28);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj, std::allocator<Obj>, MinCapacityGrowth<8>> v;
+        for (int i = 0; i < 8; ++i) {
+            v.EmplaceBack(i);
+        }
+        assert(v.Capacity() == 8);
+        assert(Obj::num_moved == 0);
+    }
+    {
+        Vector<int, PageAllocator<int>> v;
+        v.Reserve(5);
+        assert(v.Capacity() == PageAllocator<int>::PAGE);
+        v.PushBack(1);
+        v.Resize(v.Capacity());
+        v.PushBack(2);
+        assert(v.Capacity() == PageAllocator<int>::PAGE * 2);
+    }
+    {
+        MallocAllocator<double> alloc;
+        auto [ptr, count] = alloc.allocate_at_least(3);
+        assert(ptr != nullptr && count >= 3);
+        alloc.deallocate(ptr, count);
+    }
+}
+
+void Test10() {
+    const size_t SIZE = 4;
+    using SmallObjVector = SmallVector<Obj, SIZE, CountingAllocator<Obj>>;
+    // С неравными аллокаторами перемещение выделяет память и может бросить
+    static_assert(std::is_nothrow_move_assignable_v<SmallVector<int, SIZE>>);
+    static_assert(!std::is_nothrow_move_assignable_v<SmallVector<int, SIZE, std::pmr::polymorphic_allocator<int>>>);
+    {
+        Obj::ResetCounters();
+        int allocations = 0;
+        {
+            SmallObjVector v{CountingAllocator<Obj>(&allocations)};
+            assert(v.Capacity() == SIZE);
+            for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+                v.EmplaceBack(i);
+            }
+            assert(allocations == 0);
+            assert(v.IsInline());
+
+            v.EmplaceBack(v[0]);
+            assert(allocations == 1);
+            assert(!v.IsInline());
+            assert(v.Capacity() == SIZE * 2);
+            assert(v[SIZE].id == 0);
+
+            v.Emplace(v.begin() + 1, 42);
+            v.Erase(v.begin());
+            assert(v.Size() == SIZE + 1);
+            assert(v[0].id == 42 && v[1].id == 1);
+
+            SmallObjVector v_copy(v);
+            assert(allocations == 2);
+
+            SmallObjVector v_moved(std::move(v));
+            assert(allocations == 2);
+            assert(v.Size() == 0);
+            assert(v_moved.Size() == SIZE + 1);
+        }
+        assert(allocations == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, SIZE> inline_v(SIZE - 1);
+        inline_v[0].id = 1;
+        SmallVector<Obj, SIZE> heap_v(SIZE * 2);
+        heap_v[0].id = 2;
+
+        inline_v.Swap(heap_v);
+        assert(inline_v.Size() == SIZE * 2 && inline_v[0].id == 2);
+        assert(heap_v.Size() == SIZE - 1 && heap_v[0].id == 1);
+
+        heap_v = inline_v;
+        assert(heap_v.Size() == SIZE * 2 && heap_v[0].id == 2);
+        heap_v.Resize(1);
+        assert(Obj::GetAliveObjectCount() == SIZE * 2 + 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Obj::ResetCounters();
+        SmallVector<Obj, SIZE> v(SIZE);
+        v[SIZE / 2].throw_on_copy = true;
+        try {
+            SmallVector<Obj, SIZE> v_copy(v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+    }
+    {
+        SmallVector<TestObj, 1> v(1);
+        v.PushBack(std::move(v[0]));
+        assert(v[0].IsAlive());
+        assert(v[1].IsAlive());
+    }
+}
+
+void Test11() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        Vector<int> v;
+        const int values[] = {1, 2, 3, 4};
+        v.Insert(v.begin(), std::begin(values), std::end(values));
+        assert(v.Size() == 4);
+        assert(v.Capacity() == 4);
+
+        v.Insert(v.begin() + 2, SIZE, 0);
+        assert(v.Size() == SIZE + 4);
+        assert(v[1] == 2 && v[2] == 0 && v[SIZE + 1] == 0 && v[SIZE + 2] == 3);
+
+        v.Reserve(100);
+        v.Insert(v.begin(), 3, v[SIZE + 3]);
+        assert(v[0] == 4 && v[2] == 4 && v[3] == 1);
+
+        v.Append(values);
+        assert(v.Size() == SIZE + 11);
+        assert(v[SIZE + 7] == 1 && v[SIZE + 10] == 4);
+        assert(v.Capacity() == 100);
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> source(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            source[i].id = static_cast<int>(i);
+        }
+
+        for (size_t at : {size_t{0}, SIZE / 2, SIZE - 1, SIZE}) {
+            for (size_t count : {size_t{1}, SIZE / 2, SIZE * 2}) {
+                Vector<Obj> v(SIZE);
+                v.Reserve(SIZE * 4);
+                v.Insert(v.begin() + at, count, Obj(ID));
+                assert(v.Size() == SIZE + count);
+                assert(v[at].id == ID && v[at + count - 1].id == ID);
+
+                v.Insert(v.begin() + at, source.begin(), source.end());
+                assert(v.Size() == SIZE * 2 + count);
+                for (size_t i = 0; i < SIZE; ++i) {
+                    assert(v[at + i].id == static_cast<int>(i));
+                }
+                assert(v[at + SIZE].id == ID);
+            }
+        }
+        assert(Obj::GetAliveObjectCount() == SIZE);
+
+        Vector<Obj> v(SIZE);
+        source[SIZE / 2].throw_on_copy = true;
+        try {
+            v.Insert(v.begin() + 1, source.begin(), source.end());
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == SIZE);
+        assert(Obj::GetAliveObjectCount() == SIZE * 2);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v.Insert(v.begin() + 1, SIZE, ID);
+        v.Insert(v.end(), v.Size(), -1);
+        assert(v.Size() == SIZE * 4);
+        assert(v[0] == 0 && v[1] == ID && v[SIZE] == ID && v[SIZE + 1] == 0 && v[SIZE * 2] == -1);
+    }
+    {
+        std::istringstream input("1 2 3");
+        Vector<int> v(2);
+        v.Insert(v.begin() + 1, std::istream_iterator<int>(input), std::istream_iterator<int>());
+        assert(v.Size() == 5);
+        assert(v[0] == 0 && v[1] == 1 && v[3] == 3 && v[4] == 0);
+    }
+}
+
+void Test12() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+
+        auto it = v.Erase(v.begin() + 10, v.begin() + 20);
+        assert(it == v.begin() + 10);
+        assert(it->id == 20);
+        assert(v.Size() == SIZE - 10);
+        assert(Obj::GetAliveObjectCount() == SIZE - 10);
+
+        assert(v.Erase(v.begin(), v.begin()) == v.begin());
+        assert(v.Size() == SIZE - 10);
+
+        const size_t removed = v.EraseIf([](const Obj& obj) { return obj.id % 2 == 0; });
+        assert(removed == (SIZE - 10) / 2);
+        assert(v.Size() == (SIZE - 10) / 2);
+        assert(v[0].id == 1 && v[4].id == 9 && v[5].id == 21);
+        assert(Obj::GetAliveObjectCount() == (SIZE - 10) / 2);
+
+        v.Erase(v.begin() + 1, v.end());
+        assert(v.Size() == 1 && v[0].id == 1);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        Vector<std::unique_ptr<int>> v;
+        for (int i = 0; i < static_cast<int>(SIZE); ++i) {
+            v.EmplaceBack(std::make_unique<int>(i));
+        }
+        v.Erase(v.begin(), v.begin() + SIZE / 2);
+        assert(v.Size() == SIZE / 2);
+        assert(*v[0] == static_cast<int>(SIZE) / 2);
+        v.EraseIf([](const std::unique_ptr<int>& p) { return *p % 10 != 0; });
+        assert(v.Size() == 5);
+        assert(*v[1] == 60);
+    }
+}
+
+void Test13() {
+    const size_t SIZE = 1000;
+    {
+        const std::string text(SIZE / 2, 'x');
+        std::istringstream input(text);
+        Vector<char> v(1);
+        v.ResizeForOverwrite(SIZE, [&input](char* data, size_t n) {
+            input.read(data + 1, n - 1);
+            return input.gcount() + 1;
+        });
+        assert(v.Size() == SIZE / 2 + 1);
+        assert(v.Capacity() == SIZE);
+        assert(v[0] == 0 && v[1] == 'x' && v[SIZE / 2] == 'x');
+    }
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.ResizeForOverwrite(SIZE * 2, [](Obj* data, size_t n) {
+            for (size_t i = SIZE; i < n; ++i) {
+                new (data + i) Obj(static_cast<int>(i));
+            }
+            return n;
+        });
+        assert(v.Size() == SIZE * 2 && v[SIZE].id == static_cast<int>(SIZE));
+        assert(Obj::num_constructed_with_id == SIZE);
+
+        v.ResizeForOverwrite(SIZE, [](Obj*, size_t) { return size_t{10}; });
+        assert(v.Size() == 10);
+        assert(Obj::GetAliveObjectCount() == 10);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+}
+
+void Test14() {
+    const size_t SIZE = 100;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Resize(SIZE / 2);
+        v.ShrinkToFit();
+        assert(v.Size() == SIZE / 2);
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::num_moved == SIZE / 2);
+
+        v.Clear();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == SIZE / 2);
+        assert(Obj::GetAliveObjectCount() == 0);
+
+        v.Resize(2);
+        v.ReleaseMemory();
+        assert(v.Size() == 0);
+        assert(v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<int, MallocAllocator<int>> v(SIZE);
+        v.Resize(10);
+        v.ShrinkToFit();
+        assert(v.Capacity() == 10 && v[9] == 0);
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+    }
+    {
+        Vector<int, std::allocator<int>, ShrinkingGrowth<>> v;
+        for (int i = 0; i < 64; ++i) {
+            v.PushBack(i);
+        }
+        assert(v.Capacity() == 64);
+        while (v.Size() > 17) {
+            v.PopBack();
+        }
+        assert(v.Capacity() == 64);
+        v.PopBack();
+        assert(v.Capacity() == 32);
+        v.PushBack(16);
+        v.PopBack();
+        assert(v.Capacity() == 32);
+
+        auto it = v.Erase(v.begin() + 1, v.begin() + 12);
+        assert(v.Capacity() == 10);
+        assert(*it == 12);
+        v.EraseIf([](int i) { return i != 0; });
+        assert(v.Size() == 1 && v.Capacity() == 2);
+        v.Erase(v.begin());
+        assert(v.Capacity() == 1);
+    }
+}
+
+void Test15() {
+#ifdef VECTOR_ENABLE_STATS
+    const size_t SIZE = 100;
+    {
+        using Stats = VectorStats<Obj>;
+        Stats::Reset();
+        {
+            Vector<Obj> v;
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack();
+            }
+            assert(Stats::allocations == 8);
+            assert(Stats::deallocations == 7);
+            assert(Stats::reallocations == 7);
+            assert(Stats::relocated == 127);
+            assert(Stats::copied == 0);
+            assert(Stats::peak_capacity == 128);
+            assert(Stats::bytes_allocated == 255 * sizeof(Obj));
+        }
+        assert(Stats::deallocations == 8);
+    }
+    {
+        struct ThrowingMove {
+            ThrowingMove() = default;
+            ThrowingMove(const ThrowingMove&) = default;
+            ThrowingMove(ThrowingMove&&) noexcept(false) {}
+        };
+        using Stats = VectorStats<ThrowingMove>;
+        Stats::Reset();
+        Vector<ThrowingMove> v(SIZE);
+        v.Reserve(SIZE * 2);
+        assert(Stats::reallocations == 1);
+        assert(Stats::relocated == 0);
+        assert(Stats::copied == SIZE);
+    }
+#endif
+}
+
+void Test16() {
+    const size_t SIZE = 100;
+    {
+        Vector<int> source(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            source[i] = static_cast<int>(i);
+        }
+        Vector<int> copy(source);
+        assert(copy.Size() == SIZE && copy[SIZE - 1] == static_cast<int>(SIZE) - 1);
+
+        Vector<int> target(SIZE * 2);
+        const int* buffer = &target[0];
+        target = source;
+        assert(&target[0] == buffer);
+        assert(target.Size() == SIZE && target.Capacity() == SIZE * 2);
+        assert(target[0] == 0 && target[SIZE - 1] == static_cast<int>(SIZE) - 1);
+
+        const auto& self = target;
+        target = self;
+        assert(target.Size() == SIZE && target[SIZE / 2] == static_cast<int>(SIZE) / 2);
+
+        Vector<int> empty;
+        target = empty;
+        assert(target.Size() == 0 && target.Capacity() == SIZE * 2);
+    }
+}
+
+void Test17() {
+    const size_t SIZE = 1000;
+    const auto is_aligned = [](const void* p, size_t alignment) {
+        return reinterpret_cast<uintptr_t>(p) % alignment == 0;
+    };
+    {
+        Vector<float, AlignedAllocator<float, 64>> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(&v[0], 64));
+        }
+        assert(v[SIZE - 1] == static_cast<float>(SIZE - 1));
+    }
+    {
+        struct alignas(128) Block {
+            float lanes[32];
+        };
+        Vector<Block> v(3);
+        assert(is_aligned(&v[0], 128));
+        Vector<Block, AlignedAllocator<Block, 16>> aligned(3);
+        assert(is_aligned(&aligned[0], 128));
+    }
+    {
+        using Allocator = HugePageAllocator<int, 64>;
+        const size_t huge_size = HUGE_PAGE_SIZE / sizeof(int);
+        Vector<int, Allocator> v(SIZE);
+        assert(is_aligned(&v[0], 64));
+        v[0] = 42;
+
+        v.Reserve(huge_size);
+        assert(is_aligned(&v[0], HUGE_PAGE_SIZE));
+        assert(v[0] == 42 && v.Size() == SIZE);
+
+        v.Resize(huge_size);
+        v.PushBack(7);
+        assert(v.Capacity() == huge_size * 2);
+        assert(v[0] == 42 && v[huge_size] == 7);
+
+        v.Resize(SIZE);
+        v.ShrinkToFit();
+        assert(v[0] == 42 && v.Capacity() == SIZE);
+    }
+}
+
+void Test18() {
+    const size_t SIZE = 10'000;
+    const std::string path = "/tmp/mapped_vector_test_" + std::to_string(getpid());
+    struct Record {
+        int id;
+        double value;
+    };
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == 0);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(Record{static_cast<int>(i), i * 0.5});
+        }
+        v.EmplaceBack(v[0]);
+        assert(v.Size() == SIZE + 1);
+        assert(v.Capacity() == 16384);
+        assert(v[SIZE].id == 0 && v[SIZE - 1].id == static_cast<int>(SIZE) - 1);
+        v.PopBack();
+        v.Sync();
+    }
+    {
+        MappedVector<Record> v(path);
+        assert(v.Size() == SIZE);
+        assert(v.Capacity() == 16384);
+        assert(v[SIZE / 2].id == static_cast<int>(SIZE) / 2 && v[SIZE / 2].value == SIZE / 4);
+
+        v.ShrinkToFit();
+        v.Resize(SIZE + 1);
+        assert(v[SIZE].id == 0);
+
+        MappedVector<Record> moved(std::move(v));
+        assert(moved.Size() == SIZE + 1);
+    }
+    {
+        struct stat st {};
+        assert(stat(path.c_str(), &st) == 0);
+        assert(static_cast<size_t>(st.st_size) == 64 + (SIZE + 1) * sizeof(Record));
+        try {
+            MappedVector<int> wrong_type(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+
+        // Заголовок обещает больше элементов, чем осталось в обрезанном файле
+        assert(truncate(path.c_str(), 64 + SIZE * sizeof(Record)) == 0);
+        try {
+            MappedVector<Record> truncated(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(truncate(path.c_str(), 16) == 0);
+        try {
+            MappedVector<Record> no_header(path);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+    }
+    unlink(path.c_str());
+}
+
+void Test19() {
+    const size_t SIZE = 100'000;
+    Vector<double> source(SIZE);
+    for (size_t i = 0; i < SIZE; ++i) {
+        source[i] = i * 0.25;
+    }
+    {
+        const std::string path = "/tmp/vector_io_test_" + std::to_string(getpid());
+        const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        assert(fd >= 0);
+        unlink(path.c_str());
+
+        WriteTo(fd, source);
+        WriteTo(fd, Vector<double>());
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+
+        Vector<double> v(3);
+        ReadFrom(fd, v);
+        assert(v.Size() == SIZE);
+        assert(v[SIZE - 1] == (SIZE - 1) * 0.25);
+        ReadFrom(fd, v);
+        assert(v.Size() == 0);
+        v.Resize(3);
+        try {
+            ReadFrom(fd, v);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 0);
+
+        // Заголовок, обещающий больше, чем есть в файле, отвергается до выделения памяти
+        VectorIOHeader header;
+        header.element_size = sizeof(double);
+        header.element_alignment = alignof(double);
+        header.size = size_t{1} << 40;
+        assert(ftruncate(fd, 0) == 0 && lseek(fd, 0, SEEK_SET) == 0);
+        assert(write(fd, &header, sizeof(header)) == static_cast<ssize_t>(sizeof(header)));
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        Vector<double> corrupt;
+        try {
+            ReadFrom(fd, corrupt);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(corrupt.Capacity() == 0);
+        close(fd);
+    }
+    {
+        std::stringstream stream;
+        WriteTo(stream, source);
+
+        Vector<double> v;
+        ReadFrom(stream, v);
+        assert(v.Size() == SIZE && v[SIZE / 2] == SIZE / 8.0);
+
+        stream.clear();
+        stream.seekg(0);
+        Vector<float> wrong_type(2);
+        try {
+            ReadFrom(stream, wrong_type);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(wrong_type.Size() == 0);
+    }
+}
+
+void Test20() {
+    const size_t SIZE = 1'000'000;
+    const size_t THREADS = 4;
+    {
+        Vector<int> v(10);
+        v[0] = 42;
+        parallel::Resize(v, SIZE, THREADS);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE);
+        assert(v[0] == 42 && v[10] == 0 && v[SIZE - 1] == 0);
+
+        parallel::Fill(v, SIZE / 2, 7, THREADS);
+        assert(v.Size() == SIZE / 2 && v[0] == 7 && v[SIZE / 2 - 1] == 7);
+        assert(v.Capacity() == SIZE);
+
+        Vector<int> copy = parallel::Copy(v, THREADS);
+        assert(copy.Size() == SIZE / 2 && copy[SIZE / 4] == 7);
+
+        parallel::Resize(v, 1, THREADS);
+        assert(v.Size() == 1);
+    }
+    {
+        {
+            Vector<AtomicObj> v;
+            parallel::Resize(v, SIZE, THREADS);
+            assert(AtomicObj::alive == static_cast<int>(SIZE));
+
+            Vector<AtomicObj> copy = parallel::Copy(v, THREADS);
+            assert(AtomicObj::alive == static_cast<int>(SIZE * 2));
+
+            AtomicObj::throw_countdown = SIZE / 2;
+            try {
+                parallel::Resize(v, SIZE * 2, THREADS);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == SIZE);
+            assert(AtomicObj::alive == static_cast<int>(SIZE * 2));
+
+            // Старые элементы уничтожаются до построения новых, так что при исключении вектор пуст
+            AtomicObj::throw_countdown = SIZE / 2;
+            try {
+                parallel::Fill(v, SIZE, AtomicObj(), THREADS);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 0 && v.Capacity() >= SIZE);
+            assert(AtomicObj::alive == static_cast<int>(SIZE));
+        }
+        assert(AtomicObj::alive == 0);
+    }
+}
+
+void Test21() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        Obj::ResetCounters();
+        Vector<Obj> v(SIZE);
+        v.Reserve(SIZE * 2);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v[i].id = static_cast<int>(i);
+        }
+
+        Obj::ResetCounters();
+        const Obj obj(ID);
+        v.Insert(v.begin() + 1, obj);
+        assert(Obj::num_copied == 0);
+        assert(Obj::num_moved == 1);
+        assert(v[1].id == ID && v[2].id == 1 && v[SIZE].id == static_cast<int>(SIZE) - 1);
+
+        v.Insert(v.begin(), std::move(v[SIZE]));
+        assert(v[0].id == static_cast<int>(SIZE) - 1 && v[1].id == 0);
+
+        v.Insert(v.begin() + 1, v[3]);
+        assert(v[1].id == 1 && v[4].id == 1);
+
+        v.Emplace(v.begin() + 2, ID, "Ivan"s);
+        assert(v[2].name == "Ivan"s);
+        assert(Obj::num_constructed_with_id_and_name == 1);
+        assert(v.Size() == SIZE + 4);
+    }
+    {
+        RelocatableObj::ResetCounters();
+        Vector<RelocatableObj> v;
+        v.Reserve(SIZE);
+        for (int i = 0; i < static_cast<int>(SIZE) - 1; ++i) {
+            v.Emplace(v.begin(), i);
+        }
+        assert(RelocatableObj::num_moved == 0);
+        assert(RelocatableObj::num_destroyed == 0);
+        assert(*v[0].id == static_cast<int>(SIZE) - 2 && *v[SIZE - 2].id == 0);
+    }
+    {
+        Vector<std::string> v;
+        v.Reserve(SIZE);
+        v.PushBack("first"s);
+        v.PushBack("second"s);
+        v.Insert(v.begin(), v[1]);
+        assert(v[0] == "second"s && v[1] == "first"s && v[2] == "second"s);
+    }
+}
+
+void Test22() {
+    const size_t SIZE = 1000;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        ChunkedVector<Obj, 16> v;
+        v.EmplaceBack(ID);
+        const Obj* first = &v[0];
+        for (size_t i = 1; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i));
+        }
+        // Рост не перемещает элементы
+        assert(&v[0] == first);
+        assert(Obj::num_moved == 0 && Obj::num_copied == 0);
+        assert(v.Size() == SIZE && v.Capacity() == SIZE + 8);
+        assert(v[0].id == ID && v[SIZE - 1].id == static_cast<int>(SIZE) - 1);
+        assert(v.end() - v.begin() == static_cast<std::ptrdiff_t>(SIZE));
+
+        ChunkedVector<Obj, 16> copy(v);
+        assert(Obj::num_copied == SIZE);
+        assert(copy[SIZE / 2].id == v[SIZE / 2].id);
+
+        v.PopBack();
+        assert(v.Size() == SIZE - 1);
+        assert(Obj::GetAliveObjectCount() == SIZE * 2 - 1);
+
+        v.Clear();
+        v.ShrinkToFit();
+        assert(v.Capacity() == 0);
+        assert(Obj::GetAliveObjectCount() == SIZE);
+
+        v = std::move(copy);
+        assert(v.Size() == SIZE && copy.Size() == 0);
+    }
+    assert(Obj::GetAliveObjectCount() == 0);
+    {
+        ChunkedVector<int, 4> v;
+        v.Reserve(10);
+        assert(v.Capacity() == 12);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        assert(std::accumulate(v.cbegin(), v.cend(), 0) == 45);
+        assert(*std::lower_bound(v.begin(), v.end(), 7) == 7);
+    }
+    {
+        Obj::ResetCounters();
+        ChunkedVector<Obj, 4> v;
+        v.EmplaceBack(ID);
+        Obj::default_construction_throw_countdown = 1;
+        try {
+            v.EmplaceBack();
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 1 && v[0].id == ID);
+        assert(Obj::GetAliveObjectCount() == 1);
+    }
+}
+
+void Test23() {
+    const size_t SIZE = 100;
+    const int ID = 42;
+    using namespace std::literals;
+    {
+        SoaVector<int, double, std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.EmplaceBack(static_cast<int>(i), i * 0.5, std::to_string(i));
+        }
+        assert(v.Size() == SIZE && v.Capacity() >= SIZE);
+
+        auto [id, value, name] = v[SIZE - 1];
+        assert(id == static_cast<int>(SIZE) - 1 && value == (SIZE - 1) * 0.5 && name == std::to_string(SIZE - 1));
+        id = ID;
+        assert(v.Get<0>(SIZE - 1) == ID);
+
+        // Каждое поле лежит в отдельном выровненном массиве
+        auto ids = v.Column<0>();
+        assert(ids.Size() == SIZE);
+        assert(reinterpret_cast<uintptr_t>(ids.Data()) % SoaVector<int>::COLUMN_ALIGNMENT == 0);
+        assert(reinterpret_cast<uintptr_t>(v.Column<1>().Data()) % SoaVector<int>::COLUMN_ALIGNMENT == 0);
+        const auto& cv = v;
+        assert(std::accumulate(cv.Column<1>().begin(), cv.Column<1>().end(), 0.0) == SIZE * (SIZE - 1) * 0.25);
+
+        SoaVector<int, double, std::string> copy(v);
+        assert(std::get<2>(copy[SIZE / 2]) == std::to_string(SIZE / 2));
+
+        v.EmplaceBack(v.Get<0>(0), v.Get<1>(0), v.Get<2>(0));
+        assert(v.Get<2>(SIZE) == "0"s);
+
+        v.PopBack();
+        v.Resize(SIZE * 2);
+        assert(v.Get<0>(SIZE * 2 - 1) == 0 && v.Get<2>(SIZE * 2 - 1).empty());
+        v.Resize(1);
+        assert(v.Size() == 1);
+        v.Clear();
+        assert(v.Size() == 0);
+    }
+    {
+        // Исключение при копировании одного столбца оставляет вектор без изменений
+        struct CopyOnly {
+            explicit CopyOnly(int id) : id(id) {}
+            CopyOnly(const CopyOnly& other) : id(other.id) {
+                if (other.throw_on_copy) {
+                    throw std::runtime_error("Oops");
+                }
+            }
+
+            int id;
+            bool throw_on_copy = false;
+        };
+
+        Obj::ResetCounters();
+        {
+            SoaVector<Obj, CopyOnly> v;
+            v.EmplaceBack(ID, ID);
+            Obj::num_moved = 0;
+            v.Get<1>(0).throw_on_copy = true;
+            try {
+                v.EmplaceBack(ID + 1, ID + 1);
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == 1 && v.Capacity() == 1);
+            assert(v.Get<0>(0).id == ID && v.Get<1>(0).id == ID);
+            assert(Obj::num_moved == 0);
+            assert(Obj::GetAliveObjectCount() == 1);
+
+            v.Get<1>(0).throw_on_copy = false;
+            v.EmplaceBack(ID + 1, ID + 1);
+            assert(Obj::num_moved == 1);
+            assert(v.Get<0>(0).id == ID && v.Get<1>(1).id == ID + 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test24() {
+    const size_t THREADS = 4;
+    const size_t PER_THREAD = 10000;
+    {
+        ConcurrentVector<size_t, 16> v;
+        v.EmplaceBack(size_t{0});
+        const size_t* first = &v[0];
+
+        std::atomic<bool> done = false;
+        std::thread reader([&] {
+            // Опубликованные элементы можно читать, пока другие потоки добавляют новые
+            while (!done.load()) {
+                const size_t size = v.Size();
+                for (size_t i = 0; i < size; ++i) {
+                    if (v.IsPublished(i)) {
+                        assert(v[i] < THREADS * PER_THREAD + 1);
+                    }
+                }
+            }
+        });
+
+        Vector<std::thread> producers;
+        for (size_t t = 0; t < THREADS; ++t) {
+            producers.EmplaceBack([&v, t] {
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    v.EmplaceBack(t * PER_THREAD + i + 1);
+                }
+            });
+        }
+        for (std::thread& producer : producers) {
+            producer.join();
+        }
+        done = true;
+        reader.join();
+
+        assert(v.Size() == THREADS * PER_THREAD + 1);
+        assert(&v[0] == first);
+        size_t sum = 0;
+        for (size_t i = 0; i < v.Size(); ++i) {
+            assert(v.IsPublished(i));
+            sum += v[i];
+        }
+        const size_t n = THREADS * PER_THREAD;
+        assert(sum == n * (n + 1) / 2);
+    }
+    {
+        Obj::ResetCounters();
+        {
+            ConcurrentVector<Obj, 4> v;
+            v.Reserve(100);
+            v.EmplaceBack(1);
+            Obj::default_construction_throw_countdown = 1;
+            try {
+                v.EmplaceBack();
+                assert(false && "Exception is expected");
+            } catch (const std::runtime_error&) {
+            }
+            v.EmplaceBack(3);
+            assert(v.Size() == 3);
+            assert(v.IsPublished(0) && !v.IsPublished(1) && v.IsPublished(2));
+            assert(v[2].id == 3);
+            assert(Obj::GetAliveObjectCount() == 2);
+
+            v.Clear();
+            assert(v.Size() == 0 && Obj::GetAliveObjectCount() == 0);
+            v.EmplaceBack(4);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Слот, для которого не удалось выделить сегмент, остаётся без сегмента, Clear его пропускает
+        Obj::ResetCounters();
+        int budget = 1;
+        {
+            ConcurrentVector<Obj, 4, FailingAllocator<Obj>> v{FailingAllocator<Obj>(&budget)};
+            for (int i = 0; i < 4; ++i) {
+                v.EmplaceBack(i);
+            }
+            try {
+                v.EmplaceBack(4);
+                assert(false && "Exception is expected");
+            } catch (const std::bad_alloc&) {
+            }
+            assert(v.Size() == 5 && !v.IsPublished(4));
+            assert(Obj::GetAliveObjectCount() == 4);
+
+            v.Clear();
+            assert(v.Size() == 0 && Obj::GetAliveObjectCount() == 0);
+            v.EmplaceBack(5);
+            try {
+                v.EmplaceBack(6);
+                v.EmplaceBack(7);
+                v.EmplaceBack(8);
+                v.EmplaceBack(9);
+                assert(false && "Exception is expected");
+            } catch (const std::bad_alloc&) {
+            }
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+template <typename T>
+void CheckScans(size_t size) {
+    Vector<T> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<T>(i % 100);
+    }
+    const T* data = v.begin();
+
+    assert(v.Find(T{42}) == std::find(data, data + size, T{42}));
+    assert(v.Find(T{101}) == v.end());
+    assert(v.Count(T{7}) == static_cast<size_t>(std::count(data, data + size, T{7})));
+    assert(v.Sum() == std::accumulate(data, data + size, T{}));
+    if (size > 0) {
+        assert(v.Min() == *std::min_element(data, data + size));
+        assert(v.Max() == *std::max_element(data, data + size));
+    }
+
+    v.Fill(T{3});
+    assert(v.Count(T{3}) == size);
+    assert(std::all_of(data, data + size, [](T x) { return x == T{3}; }));
+}
+
+void Test25() {
+    for (size_t size : {0, 1, 15, 64, 100, 1000, 70000}) {
+        CheckScans<int>(size);
+        CheckScans<int8_t>(size);
+        CheckScans<uint16_t>(size);
+        CheckScans<int64_t>(size);
+        CheckScans<float>(size);
+        CheckScans<double>(size);
+    }
+    {
+        // Совпадение в последнем неполном блоке и минимум в середине
+        Vector<float> v(35);
+        v.Fill(1.5f);
+        v[34] = -2.0f;
+        v[17] = -3.0f;
+        assert(v.Find(-2.0f) == v.begin() + 34);
+        assert(v.Min() == -3.0f && v.Max() == 1.5f);
+        assert(v.Sum() == 1.5f * 33 - 5.0f);
+    }
+}
+
+void Test26() {
+    using namespace std::literals;
+    {
+        const int keys[] = {5, 1, 4, 1, 3, 5, 9};
+        FlatSet<int> set(std::begin(keys), std::end(keys));
+        assert(set.Size() == 5);
+        assert(std::is_sorted(set.begin(), set.end()));
+        assert(set.Contains(4) && !set.Contains(2));
+        assert(set.Find(9) == set.end() - 1 && set.Find(10) == set.end());
+
+        assert(set.Insert(2) && !set.Insert(2));
+        assert(*set.LowerBound(6) == 9);
+
+        const int batch[] = {8, 0, 3, 8, 7};
+        assert(set.Insert(std::begin(batch), std::end(batch)) == 3);
+        const int expected[] = {0, 1, 2, 3, 4, 5, 7, 8, 9};
+        assert(std::equal(set.begin(), set.end(), std::begin(expected), std::end(expected)));
+
+        assert(set.Erase(5) && !set.Erase(5));
+        assert(set.Size() == 8);
+    }
+    {
+        // Двоичный поиск без ветвлений совпадает с std::lower_bound
+        Vector<int> v;
+        for (int size = 0; size < 40; ++size) {
+            for (int key = -1; key <= 2 * size + 1; ++key) {
+                const int* found = BranchlessLowerBound(v.Data(), v.Size(), key, std::less<int>{});
+                assert(found == std::lower_bound(v.begin(), v.end(), key));
+            }
+            v.PushBack(2 * size);
+        }
+    }
+    {
+        const std::pair<std::string, int> pairs[] = {{"b"s, 2}, {"a"s, 1}, {"c"s, 3}, {"a"s, 10}};
+        FlatMap<std::string, int> map(std::begin(pairs), std::end(pairs));
+        assert(map.Size() == 3);
+        assert(map.At("a"s) == 1);
+        assert(map.Find("z"s) == nullptr);
+        try {
+            map.At("z"s);
+            assert(false && "Exception is expected");
+        } catch (const std::out_of_range&) {
+        }
+
+        map["d"s] = 4;
+        assert(map.Insert({"e"s, 5}) && !map.Insert({"e"s, 50}));
+        assert(!map.InsertOrAssign("e"s, 6) && map.At("e"s) == 6);
+        assert(map.TryEmplace("f"s, 7).second);
+
+        const std::pair<std::string, int> batch[] = {{"0"s, 0}, {"cc"s, 33}, {"a"s, 100}, {"z"s, 26}, {"0"s, -1}};
+        assert(map.Insert(std::begin(batch), std::end(batch)) == 3);
+        assert(map.Size() == 9);
+        assert(std::is_sorted(map.Keys().begin(), map.Keys().end()));
+        for (size_t i = 0; i < map.Size(); ++i) {
+            assert(map.At(map.Keys()[i]) == map.Values()[i]);
+        }
+        assert(map.At("0"s) == 0 && map.At("cc"s) == 33 && map.At("a"s) == 1 && map.At("z"s) == 26);
+
+        assert(map.Erase("cc"s) && !map.Contains("cc"s));
+        assert(map.Values().Size() == map.Size());
+    }
+}
+
+void Test27() {
+    const size_t SIZE = 10;
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        {
+            SharedVector<Obj> origin{Vector<Obj>(SIZE)};
+            origin[0].id = ID;
+
+            // Копия разделяет буфер с оригиналом
+            const SharedVector<Obj> snapshot(origin);
+            assert(origin.UseCount() == 2);
+            assert(snapshot.begin() == std::as_const(origin).begin());
+            assert(snapshot[0].id == ID && snapshot.Size() == SIZE);
+            assert(Obj::num_copied == 0);
+
+            // Изменение клонирует буфер, снимок остаётся прежним
+            origin[0].id = ID + 1;
+            assert(Obj::num_copied == SIZE);
+            assert(origin.UseCount() == 1 && snapshot.UseCount() == 1);
+            assert(origin[0].id == ID + 1 && snapshot[0].id == ID);
+
+            // Единственный владелец изменяет буфер без копирования
+            origin.EmplaceBack(ID);
+            origin.Erase(origin.begin());
+            assert(Obj::num_copied == SIZE);
+
+            SharedVector<Obj> other = snapshot;
+            other.EmplaceBack(other[1]);
+            assert(other.Size() == SIZE + 1 && snapshot.Size() == SIZE);
+            assert(other.Capacity() > other.Size() - 1);
+
+            SharedVector<Obj> erased = snapshot;
+            erased.Erase(erased.begin() + 1, erased.end());
+            assert(erased.Size() == 1 && erased[0].id == ID && snapshot.Size() == SIZE);
+
+            SharedVector<Obj> cleared = snapshot;
+            const int copied = Obj::num_copied;
+            cleared.Clear();
+            assert(cleared.Size() == 0 && snapshot.UseCount() == 1 && Obj::num_copied == copied);
+
+            cleared.PushBack(Obj(ID));
+            assert(cleared.Size() == 1);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Снимки раздаются потокам без копирования элементов
+        SharedVector<int> table{Vector<int>(SIZE)};
+        Vector<std::thread> workers;
+        std::atomic<int> sum = 0;
+        for (int i = 0; i < 4; ++i) {
+            workers.EmplaceBack([snapshot = table, &sum]() mutable {
+                sum += std::accumulate(snapshot.begin(), snapshot.end(), 0);
+                snapshot.PushBack(1);
+                sum += snapshot[SIZE];
+            });
+        }
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        assert(sum == 4 && table.UseCount() == 1 && table.Size() == SIZE);
+    }
+}
+
+#if __cplusplus >= 202002L
+// Таблица квадратов простых чисел, вычисленная при компиляции
+constexpr std::array<int, 8> BuildPrimeSquares() {
+    Vector<int> primes;
+    for (int n = 2; primes.Size() < 8; ++n) {
+        bool is_prime = true;
+        for (int p : primes) {
+            is_prime = is_prime && n % p != 0;
+        }
+        if (is_prime) {
+            primes.PushBack(n);
+        }
+    }
+
+    std::array<int, 8> squares{};
+    for (size_t i = 0; i < primes.Size(); ++i) {
+        squares[i] = primes[i] * primes[i];
+    }
+    return squares;
+}
+
+constexpr size_t ConstexprStrings() {
+    Vector<std::string> words(2);
+    words.EmplaceBack("a string too long for the small string buffer");
+    words.Insert(words.begin(), words[2]);
+    words.Emplace(words.begin() + 1, 3, 'x');
+    words.Erase(words.begin() + 2);
+
+    Vector<std::string> copy = words;
+    copy.Erase(copy.begin(), copy.begin() + 1);
+    copy.Resize(5);
+    copy.ShrinkToFit();
+    return copy[0].size() + copy.Size();
+}
+
+// Вставки диапазонов и повторов: со сдвигом хвоста в обе стороны и с перевыделением
+constexpr size_t ConstexprInserts() {
+    const int digits[] = {1, 2, 3, 4};
+    Vector<int> v;
+    v.Reserve(16);
+    v.Append(digits);
+    v.Insert(v.begin() + 1, 2, 0);
+    v.Insert(v.end() - 1, std::begin(digits), std::end(digits));
+    v.Insert(v.begin(), 10, 7);
+
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    return sum * 100 + v.Size();
+}
+
+constexpr size_t ConstexprStringInserts() {
+    const std::string batch[] = {"one", "two"};
+    Vector<std::string> words(3);
+    words.Reserve(8);
+    words.Insert(words.begin() + 1, std::begin(batch), std::end(batch));
+    words.Insert(words.begin(), 1, std::string(40, 'x'));
+    return words[0].size() + words[2].size() + words.Size();
+}
+
+constexpr std::array<int, 8> PRIME_SQUARES = BuildPrimeSquares();
+static_assert(PRIME_SQUARES[0] == 4 && PRIME_SQUARES[7] == 361);
+static_assert(ConstexprStrings() == 8);
+static_assert(ConstexprInserts() == 9020);
+static_assert(ConstexprStringInserts() == 49);
+#endif
+
+void Test28() {
+    const int ID = 42;
+    {
+        Obj::ResetCounters();
+        {
+            StaticVector<Obj, 4> v(2);
+            assert(v.Size() == 2 && v.Capacity() == 4);
+            v.EmplaceBack(ID);
+            v.Insert(v.begin(), v[2]);
+            assert(v.Size() == 4 && v[0].id == ID && v[3].id == ID);
+
+            // При переполнении бросается bad_alloc, вектор не меняется
+            try {
+                v.EmplaceBack(ID);
+                assert(false);
+            } catch (const std::bad_alloc&) {
+            }
+            try {
+                v.Emplace(v.begin(), ID);
+                assert(false);
+            } catch (const std::bad_alloc&) {
+            }
+            assert(v.Size() == 4 && Obj::GetAliveObjectCount() == 4);
+
+            v.Erase(v.begin() + 1);
+            assert(v.Size() == 3 && v[0].id == ID && v[2].id == ID);
+            v.Erase(v.begin(), v.begin() + 2);
+            assert(v.Size() == 1 && v[0].id == ID);
+
+            StaticVector<Obj, 4> copy(v);
+            copy.Resize(3);
+            StaticVector<Obj, 4> moved(std::move(copy));
+            assert(moved.Size() == 3 && moved[0].id == ID);
+
+            v = moved;
+            assert(v.Size() == 3);
+            moved.Clear();
+            moved.Swap(v);
+            assert(moved.Size() == 3 && v.Size() == 0);
+            v = std::move(moved);
+            v.PopBack();
+            assert(v.Size() == 2 && v[0].id == ID);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        // Удаление пустого диапазона не трогает элементы
+        const std::string LONG(40, 'x');
+        StaticVector<std::string, 4> v;
+        v.PushBack(LONG);
+        v.PushBack(LONG);
+        v.Erase(v.begin(), v.begin());
+        assert(v.Size() == 2 && v[0] == LONG && v[1] == LONG);
+    }
+#if __cplusplus >= 202002L
+    assert(PRIME_SQUARES[1] == 9);
+#endif
+}
+
+void Test29() {
+    const size_t SIZE = 100;
+    {
+        Vector<int> v;
+        v.Reserve(SIZE);
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.UncheckedEmplaceBack(static_cast<int>(i));
+        }
+        assert(v.Size() == SIZE && v[SIZE - 1] == static_cast<int>(SIZE - 1));
+    }
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v(1);
+            {
+                Vector<Obj>::BackCursor cursor = v.ReserveBack(SIZE);
+                assert(cursor.Room() == v.Capacity() - 1);
+                for (size_t i = 0; i < SIZE; ++i) {
+                    cursor.EmplaceBack(static_cast<int>(i));
+                }
+                // Размер фиксируется при уничтожении курсора
+                assert(v.Size() == 1);
+            }
+            assert(v.Size() == SIZE + 1 && v[SIZE].id == static_cast<int>(SIZE - 1));
+
+            // Элементы, добавленные до исключения, остаются в векторе
+            Obj::default_construction_throw_countdown = 3;
+            try {
+                Vector<Obj>::BackCursor cursor = v.ReserveBack(SIZE);
+                for (size_t i = 0; i < SIZE; ++i) {
+                    cursor.EmplaceBack();
+                }
+                assert(false);
+            } catch (const std::runtime_error&) {
+            }
+            assert(v.Size() == SIZE + 3);
+            assert(Obj::GetAliveObjectCount() == SIZE + 3);
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+}
+
+void Test30() {
+    const size_t SIZE = 10;
+    {
+        Obj::ResetCounters();
+        {
+            Vector<Obj> v;
+            for (size_t i = 0; i < SIZE; ++i) {
+                v.EmplaceBack(static_cast<int>(i));
+            }
+
+            // Последний элемент переносится на место удалённого
+            auto it = v.EraseUnordered(v.begin() + 2);
+            assert(it == v.begin() + 2 && it->id == 9 && v.Size() == SIZE - 1);
+            it = v.EraseUnordered(v.end() - 1);
+            assert(it == v.end() && v.Size() == SIZE - 2);
+            assert(Obj::num_copied == 0);
+
+            // Сейчас в векторе {0, 1, 9, 3, 4, 5, 6, 7}; индексы идут в произвольном порядке и с повторами
+            const size_t indices[] = {7, 0, 3, 7, 1};
+            assert(v.EraseUnorderedIndices(std::begin(indices), std::end(indices)) == 4);
+            assert(v.Size() == SIZE - 6);
+            Vector<int> ids;
+            for (const Obj& obj : v) {
+                ids.PushBack(obj.id);
+            }
+            std::sort(ids.begin(), ids.end());
+            const int expected[] = {4, 5, 6, 9};
+            assert(std::equal(ids.begin(), ids.end(), std::begin(expected), std::end(expected)));
+        }
+        assert(Obj::GetAliveObjectCount() == 0);
+    }
+    {
+        Vector<std::string> v;
+        for (size_t i = 0; i < SIZE; ++i) {
+            v.PushBack(std::to_string(i));
+        }
+        const size_t indices[] = {9, 0, 4, 5, 5};
+        assert(v.EraseIndices(std::begin(indices), std::end(indices)) == 4);
+        const std::string expected[] = {"1", "2", "3", "6", "7", "8"};
+        assert(std::equal(v.begin(), v.end(), std::begin(expected), std::end(expected)));
+        assert(v.EraseIndices(std::begin(indices), std::begin(indices)) == 0 && v.Size() == 6);
+    }
+}
+
+void Test31() {
+#ifdef VECTOR_ENABLE_POOL
+    const size_t SIZE = 100;
+    vector_pool::Drain();
+    {
+        // Буфер уничтоженного вектора достаётся следующему вектору того же класса размера
+        const int* address = nullptr;
+        {
+            Vector<int> v(SIZE);
+            address = v.begin();
+        }
+        const vector_pool::Stats before = vector_pool::LocalStats();
+        Vector<int> reused(SIZE - 1);
+        assert(reused.begin() == address && reused.Capacity() == SIZE - 1);
+        assert(vector_pool::LocalStats().hits == before.hits + 1);
+
+        // Классы общие для всех типов элементов
+        const void* float_address = nullptr;
+        {
+            Vector<float> floats(SIZE);
+            float_address = floats.begin();
+        }
+        Vector<unsigned> other(SIZE);
+        assert(static_cast<const void*>(other.begin()) == float_address);
+    }
+    {
+        // Кэш ограничен: лишние буферы возвращаются operator delete
+        Vector<Vector<int>> many;
+        many.Reserve(2 * vector_pool::BLOCKS_PER_CLASS);
+        for (size_t i = 0; i < 2 * vector_pool::BLOCKS_PER_CLASS; ++i) {
+            many.EmplaceBack(SIZE);
+        }
+        many.Clear();
+        const vector_pool::Stats before = vector_pool::LocalStats();
+        for (size_t i = 0; i < 2 * vector_pool::BLOCKS_PER_CLASS; ++i) {
+            many.EmplaceBack(SIZE);
+        }
+        const vector_pool::Stats after = vector_pool::LocalStats();
+        assert(after.hits - before.hits == vector_pool::BLOCKS_PER_CLASS);
+        assert(after.misses - before.misses == vector_pool::BLOCKS_PER_CLASS);
+    }
+    {
+        // У каждого потока свой кэш, он освобождается при выходе из потока
+        std::thread worker([] {
+            { Vector<int> v(SIZE); }
+            Vector<int> reused(SIZE);
+            assert(vector_pool::LocalStats().hits == 1 && vector_pool::LocalStats().misses == 1);
+        });
+        worker.join();
+    }
+    static_assert(!vector_pool::IS_POOLED<int, MallocAllocator<int>>);
+    struct alignas(64) CacheLine {
+        char bytes[64];
+    };
+    static_assert(!vector_pool::IS_POOLED<CacheLine, std::allocator<CacheLine>>);
+#endif
+}
+
+void Test32() {
+    const size_t SIZE = 100'000;
+    const size_t CHUNK_BYTES = 4096;
+    Vector<int64_t> source(SIZE);
+    std::iota(source.begin(), source.end(), int64_t{0});
+
+    const std::string path = "/tmp/vector_stream_test_" + std::to_string(getpid());
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    unlink(path.c_str());
+    WriteTo(fd, source);
+    {
+        // Куски приходят по порядку и уже прочитаны целиком
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        Vector<int64_t> v(3);
+        size_t chunks = 0;
+        int64_t expected = 0;
+        StreamFrom(
+            fd, v,
+            [&](int64_t* data, size_t n) {
+                assert(n <= CHUNK_BYTES / sizeof(int64_t));
+                for (size_t i = 0; i < n; ++i) {
+                    assert(data[i] == expected++);
+                    data[i] *= 2;
+                }
+                ++chunks;
+            },
+            CHUNK_BYTES);
+        assert(v.Size() == SIZE && v[SIZE - 1] == 2 * static_cast<int64_t>(SIZE - 1));
+        assert(chunks == (SIZE * sizeof(int64_t) + CHUNK_BYTES - 1) / CHUNK_BYTES);
+    }
+    {
+        // Исключение из обработчика останавливает чтение, вектор остаётся пустым
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        Vector<int64_t> v;
+        size_t chunks = 0;
+        try {
+            StreamFrom(
+                fd, v,
+                [&chunks](int64_t*, size_t) {
+                    if (++chunks == 3) {
+                        throw std::runtime_error("parse error");
+                    }
+                },
+                CHUNK_BYTES);
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 0 && chunks == 3);
+    }
+    {
+        // Обрезанный файл
+        assert(ftruncate(fd, sizeof(VectorIOHeader) + SIZE * sizeof(int64_t) / 2) == 0);
+        assert(lseek(fd, 0, SEEK_SET) == 0);
+        Vector<int64_t> v;
+        try {
+            StreamFrom(fd, v, [](int64_t*, size_t) {});
+            assert(false && "Exception is expected");
+        } catch (const std::runtime_error&) {
+        }
+        assert(v.Size() == 0 && v.Capacity() == 0);
+    }
+    close(fd);
+}
+
+void Test33() {
+#if VECTOR_HARDENING > 0
+    const auto expect_failure = [](auto&& operation) {
+        try {
+            operation();
+            assert(false && "Exception is expected");
+        } catch (const std::logic_error&) {
+        }
+    };
+    const hardening::Handler previous = hardening::SetHandler([](const char* what) { throw std::logic_error(what); });
+
+    if constexpr (hardening::SAMPLE_PERIOD == 1) {
+        Vector<int> v(3);
+        Vector<int> other(3);
+        expect_failure([&v] { static_cast<void>(v[3]); });
+        expect_failure([&v, &other] { v.Erase(other.begin()); });
+        expect_failure([&v] { v.Erase(v.end()); });
+        expect_failure([&v] { v.Erase(v.begin() + 2, v.begin() + 1); });
+        const size_t past_end[] = {0, 3};
+        expect_failure([&v, &past_end] { v.EraseIndices(std::begin(past_end), std::end(past_end)); });
+        expect_failure([&v, &past_end] {
+            v.EraseUnorderedIndices(std::begin(past_end), std::end(past_end));
+        });
+        assert(v.Size() == 3);
+        expect_failure([&v] { v.Insert(v.begin() + 4, 1); });
+        v.Clear();
+        expect_failure([&v] { v.PopBack(); });
+
+        // Неудачная проверка не меняет вектор
+        assert(v.Size() == 0);
+        v.PushBack(1);
+        assert(v[0] == 1);
+    }
+#if VECTOR_HARDENING > 1
+    if constexpr (hardening::SAMPLE_PERIOD == 1) {
+        Vector<int> v(3);
+        const auto it = v.begin();
+        const Vector<int>::const_iterator cit = it + 1;
+        assert(*it == 0 && it.IsValid() && cit - it == 1);
+
+        // После перевыделения старые итераторы недействительны
+        v.Reserve(v.Capacity() + 1);
+        assert(!it.IsValid() && !cit.IsValid());
+        expect_failure([&it] { static_cast<void>(*it); });
+        expect_failure([&v, &cit] { v.Erase(cit); });
+        assert(v.Size() == 3);
+
+        auto valid = v.begin();
+        v.PushBack(1);
+        assert(valid.IsValid() && *valid == 0);
+    }
+#endif
+    {
+        // Проверяется каждый SAMPLE_PERIOD-й вектор потока
+        size_t detected = 0;
+        for (size_t i = 0; i < 3 * hardening::SAMPLE_PERIOD; ++i) {
+            Vector<int> v(2);
+            v.PopBack();
+            try {
+                static_cast<void>(v[1]);
+            } catch (const std::logic_error&) {
+                ++detected;
+            }
+        }
+        assert(detected == 3);
+    }
+
+    hardening::SetHandler(previous);
+#endif
+}
+
+#ifdef VECTOR_ENABLE_CAPACITY_HINTS
+// Все векторы строятся в одном месте, они и учатся вместе
+Vector<int> BuildAtOneSite(size_t size) {
+    Vector<int> v;
+    for (size_t i = 0; i < size; ++i) {
+        v.PushBack(static_cast<int>(i));
+    }
+    return v;
+}
+#endif
+
+void Test34() {
+#ifdef VECTOR_ENABLE_CAPACITY_HINTS
+    capacity_hints::Reset();
+    {
+        // Без истории вектор растёт как обычно
+        assert(BuildAtOneSite(1).Capacity() == 1);
+
+        // Дальше первое выделение сразу получает выученную ёмкость
+        for (size_t i = 0; i < 10; ++i) {
+            BuildAtOneSite(1000);
+        }
+        const Vector<int> v = BuildAtOneSite(1);
+        assert(v.Capacity() == 1024);
+
+        // Пустой вектор по-прежнему ничего не выделяет
+        assert(BuildAtOneSite(0).Capacity() == 0);
+    }
+    {
+        // Подсказка — 90-й перцентиль, редкий выброс её не раздувает
+        capacity_hints::Reset();
+        for (size_t i = 0; i < 9; ++i) {
+            BuildAtOneSite(10);
+        }
+        BuildAtOneSite(100000);
+        assert(BuildAtOneSite(1).Capacity() == 16);
+
+        // Перемещённый вектор не записывает свой размер
+        Vector<int> source = BuildAtOneSite(10);
+        Vector<int> target(std::move(source));
+        assert(target.Capacity() == 16);
+    }
+    {
+        // Выученное сохраняется и загружается при следующем запуске
+        std::stringstream table;
+        capacity_hints::Dump(table);
+        assert(table.str().find("BuildAtOneSite") != std::string::npos);
+
+        capacity_hints::Reset();
+        std::stringstream empty;
+        capacity_hints::Dump(empty);
+        assert(empty.str().find("BuildAtOneSite") == std::string::npos);
+
+        capacity_hints::Load(table);
+        assert(BuildAtOneSite(1).Capacity() == 16);
+
+        // Загруженная подсказка держится, пока место не наберёт LEARN_PERIOD своих размеров
+        for (size_t i = 0; i + 2 < capacity_hints::LEARN_PERIOD; ++i) {
+            BuildAtOneSite(1);
+        }
+        assert(BuildAtOneSite(1).Capacity() == 16);
+        assert(BuildAtOneSite(1).Capacity() == 1);
+    }
+    capacity_hints::Reset();
+#endif
+}
+
 int main() {
     try {
         Test1();
@@ -387,6 +2237,35 @@ int main() {
         Test3();
         Test4();
         Test5();
+        Test6();
+        Test7();
+        Test8();
+        Test9();
+        Test10();
+        Test11();
+        Test12();
+        Test13();
+        Test14();
+        Test15();
+        Test16();
+        Test17();
+        Test18();
+        Test19();
+        Test20();
+        Test21();
+        Test22();
+        Test23();
+        Test24();
+        Test25();
+        Test26();
+        Test27();
+        Test28();
+        Test29();
+        Test30();
+        Test31();
+        Test32();
+        Test33();
+        Test34();
     } catch (const std::exception& e) {
         std::cerr << e.what() << std::endl;
     }
@@ -0,0 +1,262 @@
+#pragma once
+#include "vector.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Vector of trivially copyable elements stored in a memory-mapped file. Opening an existing file maps it
+// without reading or parsing anything, growth extends the file with ftruncate and remaps it, and the
+// contents persist when the vector is destroyed. The file starts with a small header that records the size
+// and element layout; the rest of it is the element buffer, so its length determines the capacity.
+template <typename T, typename Growth = DoublingGrowth>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<T>, "elements are persisted as raw bytes");
+
+    struct Header {
+        uint64_t magic;
+        uint64_t element_size;
+        uint64_t element_alignment;
+        uint64_t size;
+    };
+
+    static constexpr uint64_t MAGIC = 0x524f544345564d4d;  // "MMVECTOR"
+    static constexpr size_t DATA_OFFSET = 64;
+
+    static_assert(sizeof(Header) <= DATA_OFFSET && alignof(T) <= DATA_OFFSET);
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    // Opens the file at path or creates an empty one
+    explicit MappedVector(const std::string& path) {
+        fd_ = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+
+        try {
+            struct stat st {};
+            if (fstat(fd_, &st) != 0) {
+                ThrowSystemError("fstat " + path);
+            }
+
+            if (st.st_size == 0) {
+                Truncate(DATA_OFFSET);
+                Map(DATA_OFFSET);
+                *GetHeader() = Header{MAGIC, sizeof(T), alignof(T), 0};
+            } else {
+                if (static_cast<size_t>(st.st_size) < DATA_OFFSET) {
+                    throw std::runtime_error(path + " is not a mapped vector");
+                }
+                Map(st.st_size);
+                const Header& header = *GetHeader();
+                if (header.magic != MAGIC || header.element_size != sizeof(T)
+                    || header.element_alignment != alignof(T)) {
+                    throw std::runtime_error(path + " holds elements of a different type");
+                }
+                size_ = header.size;
+            }
+
+            capacity_ = (length_ - DATA_OFFSET) / sizeof(T);
+            if (size_ > capacity_) {
+                throw std::runtime_error(path + " is truncated");
+            }
+        } catch (...) {
+            Close();
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept
+        : fd_(std::exchange(other.fd_, -1)),
+          mapping_(std::exchange(other.mapping_, nullptr)),
+          length_(std::exchange(other.length_, 0)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~MappedVector() { Close(); }
+
+    iterator begin() noexcept { return Data(); }
+
+    iterator end() noexcept { return Data() + size_; }
+
+    const_iterator begin() const noexcept { return Data(); }
+
+    const_iterator end() const noexcept { return Data() + size_; }
+
+    const_iterator cbegin() const noexcept { return Data(); }
+
+    const_iterator cend() const noexcept { return Data() + size_; }
+
+    size_t Size() const noexcept { return size_; }
+
+    size_t Capacity() const noexcept { return capacity_; }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+
+        const size_t new_length = DATA_OFFSET + new_capacity * sizeof(T);
+
+        Truncate(new_length);
+        Remap(new_length);
+        capacity_ = new_capacity;
+    }
+
+    // New elements are value-initialized: the file is extended with zeroes
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        if (new_size > size_) {
+            std::uninitialized_value_construct_n(Data() + size_, new_size - size_);
+        }
+
+        SetSize(new_size);
+    }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        // Built before the mapping may move, since args may refer to elements of this vector
+        T value(std::forward<Args>(args)...);
+
+        if (size_ == capacity_) {
+            Reserve(Growth::NextCapacity(size_));
+        }
+
+        Data()[size_] = value;
+        SetSize(size_ + 1);
+
+        return Data()[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        SetSize(size_ - 1);
+    }
+
+    void Clear() noexcept { SetSize(0); }
+
+    // Truncates the file to the current size
+    void ShrinkToFit() {
+        if (size_ == capacity_) {
+            return;
+        }
+
+        const size_t new_length = DATA_OFFSET + size_ * sizeof(T);
+
+        Remap(new_length);
+        Truncate(new_length);
+        capacity_ = size_;
+    }
+
+    // Blocks until the contents are written to the file
+    void Sync() {
+        if (msync(mapping_, length_, MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    void Swap(MappedVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mapping_, other.mapping_);
+        std::swap(length_, other.length_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    const T& operator[](size_t index) const noexcept { return Data()[index]; }
+
+    T& operator[](size_t index) noexcept { return Data()[index]; }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    Header* GetHeader() noexcept { return static_cast<Header*>(mapping_); }
+
+    T* Data() noexcept { return reinterpret_cast<T*>(static_cast<char*>(mapping_) + DATA_OFFSET); }
+
+    const T* Data() const noexcept {
+        return reinterpret_cast<const T*>(static_cast<const char*>(mapping_) + DATA_OFFSET);
+    }
+
+    void SetSize(size_t size) noexcept {
+        size_ = size;
+        GetHeader()->size = size;
+    }
+
+    void Truncate(size_t length) {
+        if (ftruncate(fd_, static_cast<off_t>(length)) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    void Map(size_t length) {
+        void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        mapping_ = mapping;
+        length_ = length;
+    }
+
+    void Remap(size_t length) {
+#if defined(__linux__)
+        void* mapping = mremap(mapping_, length_, length, MREMAP_MAYMOVE);
+        if (mapping == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+        mapping_ = mapping;
+        length_ = length;
+#else
+        void* old_mapping = mapping_;
+        const size_t old_length = length_;
+        Map(length);
+        munmap(old_mapping, old_length);
+#endif
+    }
+
+    void Close() noexcept {
+        if (mapping_ != nullptr) {
+            munmap(mapping_, length_);
+            mapping_ = nullptr;
+        }
+        if (fd_ >= 0) {
+            close(fd_);
+            fd_ = -1;
+        }
+    }
+
+private:
+    int fd_ = -1;
+    void* mapping_ = nullptr;
+    size_t length_ = 0;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
@@ -0,0 +1,151 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+
+// Copy-on-write Vector. Copies share one reference-counted buffer, so handing a snapshot to another thread
+// is an atomic increment; the first mutating call on a handle that shares its buffer clones it. Const
+// access never clones. Distinct handles may be used from different threads, a single handle may not.
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class SharedVector {
+    using Elements = Vector<T, Alloc, Growth>;
+
+    struct Block {
+        explicit Block(Elements elements) : elements(std::move(elements)) {}
+
+        std::atomic<size_t> refs{1};
+        Elements elements;
+    };
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    SharedVector() = default;
+
+    explicit SharedVector(Elements elements) : block_(new Block(std::move(elements))) {}
+
+    SharedVector(const SharedVector& other) noexcept : block_(other.block_) {
+        if (block_ != nullptr) {
+            block_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    SharedVector(SharedVector&& other) noexcept : block_(std::exchange(other.block_, nullptr)) {}
+
+    SharedVector& operator=(const SharedVector& other) noexcept {
+        SharedVector temp(other);
+        Swap(temp);
+        return *this;
+    }
+
+    SharedVector& operator=(SharedVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~SharedVector() { Release(); }
+
+    const_iterator begin() const noexcept { return Get().begin(); }
+
+    const_iterator end() const noexcept { return Get().end(); }
+
+    const_iterator cbegin() const noexcept { return Get().begin(); }
+
+    const_iterator cend() const noexcept { return Get().end(); }
+
+    size_t Size() const noexcept { return Get().Size(); }
+
+    size_t Capacity() const noexcept { return Get().Capacity(); }
+
+    // Number of handles sharing the buffer
+    size_t UseCount() const noexcept {
+        return block_ != nullptr ? block_->refs.load(std::memory_order_acquire) : 0;
+    }
+
+    const Elements& Get() const noexcept { return block_ != nullptr ? block_->elements : EMPTY; }
+
+    // Clones the buffer if it is shared. The reference stays valid until this handle is copied.
+    Elements& Mutable() { return Detach(Size()); }
+
+    void Reserve(size_t new_capacity) { Mutable().Reserve(new_capacity); }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        // The clone gets room for the new element. args may refer to the shared buffer, which other handles
+        // keep alive.
+        Elements& elements = Detach(Size() == Capacity() ? Growth::NextCapacity(Size()) : Capacity());
+        return elements.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PopBack() {
+        assert(Size() > 0);
+        Mutable().PopBack();
+    }
+
+    // pos may point into the shared buffer
+    iterator Erase(const_iterator pos) {
+        const size_t index = pos - begin();
+        Elements& elements = Mutable();
+        return elements.Erase(elements.begin() + index);
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        const size_t from = first - begin();
+        const size_t to = last - begin();
+        Elements& elements = Mutable();
+        return elements.Erase(elements.begin() + from, elements.begin() + to);
+    }
+
+    // Drops this handle's reference instead of cloning the buffer to destroy its elements
+    void Clear() noexcept {
+        if (IsShared()) {
+            Release();
+            block_ = nullptr;
+        } else if (block_ != nullptr) {
+            block_->elements.Clear();
+        }
+    }
+
+    void Swap(SharedVector& other) noexcept { std::swap(block_, other.block_); }
+
+    const T& operator[](size_t index) const noexcept { return Get()[index]; }
+
+    T& operator[](size_t index) { return Mutable()[index]; }
+
+private:
+    bool IsShared() const noexcept { return UseCount() > 1; }
+
+    // Makes this handle the only owner of its buffer, cloning it into one of at least `capacity` if needed
+    Elements& Detach(size_t capacity) {
+        if (block_ == nullptr) {
+            block_ = new Block(Elements());
+        } else if (IsShared()) {
+            Elements copy(block_->elements.GetAllocator());
+            copy.Reserve(capacity);
+            copy.Insert(copy.end(), begin(), end());
+
+            Block* block = new Block(std::move(copy));
+            Release();
+            block_ = block;
+        }
+        return block_->elements;
+    }
+
+    void Release() noexcept {
+        if (block_ != nullptr && block_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete block_;
+        }
+    }
+
+private:
+    inline static const Elements EMPTY{};
+
+    Block* block_ = nullptr;
+};
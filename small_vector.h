@@ -0,0 +1,244 @@
+#pragma once
+#include "vector.h"
+
+// Vector that keeps up to N elements in inline storage and spills to a RawMemory buffer beyond that.
+// Element operations give the same exception guarantees as Vector.
+template <typename T, size_t N, typename Alloc = std::allocator<T>>
+class SmallVector {
+    static_assert(N > 0, "use Vector for containers without inline storage");
+
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    // Moving between unequal allocators copies the elements into a new buffer, which may throw
+    static constexpr bool NOTHROW_MOVE_ASSIGN =
+        std::is_nothrow_move_constructible_v<T> && AllocTraits::is_always_equal::value;
+
+public:
+    using iterator = T*;
+    using const_iterator = const T*;
+    using allocator_type = Alloc;
+
+    SmallVector() = default;
+
+    explicit SmallVector(const Alloc& alloc) noexcept : heap_(alloc) {}
+
+    explicit SmallVector(size_t size, const Alloc& alloc = Alloc()) : heap_(alloc) {
+        Reserve(size);
+        std::uninitialized_value_construct_n(begin(), size);
+        size_ = size;
+    }
+
+    SmallVector(const SmallVector& other)
+        : heap_(AllocTraits::select_on_container_copy_construction(other.heap_.GetAllocator())) {
+        Reserve(other.size_);
+        std::uninitialized_copy_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        : heap_(other.heap_.GetAllocator()) {
+        StealFrom(other);
+    }
+
+    SmallVector& operator=(const SmallVector& other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        if (other.size_ > Capacity()) {
+            SmallVector temp(other);
+            *this = std::move(temp);
+        } else {
+            std::copy_n(other.begin(), std::min(size_, other.size_), begin());
+
+            if (size_ > other.size_) {
+                std::destroy_n(begin() + other.size_, size_ - other.size_);
+            } else if (size_ < other.size_) {
+                std::uninitialized_copy_n(other.begin() + size_, other.size_ - size_, begin() + size_);
+            }
+
+            size_ = other.size_;
+        }
+
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& rhs) noexcept(NOTHROW_MOVE_ASSIGN) {
+        if (this != &rhs) {
+            Clear();
+            if (!rhs.IsInline() && heap_.GetAllocator() != rhs.heap_.GetAllocator()) {
+                Reserve(rhs.size_);
+            }
+            StealFrom(rhs);
+        }
+        return *this;
+    }
+
+    ~SmallVector() { std::destroy_n(begin(), size_); }
+
+    iterator begin() noexcept { return Data(); }
+
+    iterator end() noexcept { return Data() + size_; }
+
+    const_iterator begin() const noexcept { return Data(); }
+
+    const_iterator end() const noexcept { return Data() + size_; }
+
+    const_iterator cbegin() const noexcept { return Data(); }
+
+    const_iterator cend() const noexcept { return Data() + size_; }
+
+    size_t Size() const noexcept { return size_; }
+
+    size_t Capacity() const noexcept { return IsInline() ? N : heap_.Capacity(); }
+
+    bool IsInline() const noexcept { return heap_.Capacity() == 0; }
+
+    Alloc GetAllocator() const noexcept { return heap_.GetAllocator(); }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= Capacity()) {
+            return;
+        }
+
+        RawMemory<T, Alloc> new_data(new_capacity, heap_.GetAllocator());
+
+        RelocateN(begin(), size_, new_data.GetAddress());
+
+        heap_.Swap(new_data);
+    }
+
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        } else if (new_size > size_) {
+            std::uninitialized_default_construct_n(begin() + size_, new_size - size_);
+        }
+
+        size_ = new_size;
+    }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(begin() + size_);
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        if (size_ == Capacity()) {
+            return *Grow(size_, std::forward<Args>(args)...);
+        }
+
+        new (end()) T(std::forward<Args>(args)...);
+        ++size_;
+
+        return begin()[size_ - 1];
+    }
+
+    iterator Insert(const_iterator pos, const T& value) { return Emplace(pos, value); }
+
+    iterator Insert(const_iterator pos, T&& value) { return Emplace(pos, std::move(value)); }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator p, Args&&... args) {
+        size_t dist = p - cbegin();
+
+        if (size_ == Capacity()) {
+            return Grow(dist, std::forward<Args>(args)...);
+        }
+
+        if (dist == size_) {
+            new (end()) T(std::forward<Args>(args)...);
+        } else {
+            T temp(std::forward<Args>(args)...);
+            new (end()) T(std::move(*(end() - 1)));
+            std::move_backward(begin() + dist, end() - 1, end());
+            begin()[dist] = std::move(temp);
+        }
+
+        ++size_;
+
+        return begin() + dist;
+    }
+
+    iterator Erase(const_iterator p) {
+        iterator pos = begin() + (p - cbegin());
+
+        if (begin() == end()) {
+            return pos;
+        }
+
+        std::move(pos + 1, end(), pos);
+        PopBack();
+
+        return pos;
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    void Swap(SmallVector& other) noexcept(NOTHROW_MOVE_ASSIGN) {
+        SmallVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    const T& operator[](size_t index) const noexcept { return Data()[index]; }
+
+    T& operator[](size_t index) noexcept { return Data()[index]; }
+
+private:
+    T* Data() noexcept { return IsInline() ? reinterpret_cast<T*>(inline_) : heap_.GetAddress(); }
+
+    const T* Data() const noexcept {
+        return IsInline() ? reinterpret_cast<const T*>(inline_) : heap_.GetAddress();
+    }
+
+    // Spills into a heap buffer with room for a new element at `index`, which is built first because args
+    // may refer to elements of this vector.
+    template <typename... Args>
+    iterator Grow(size_t index, Args&&... args) {
+        RawMemory<T, Alloc> new_data(size_ * 2, heap_.GetAllocator());
+
+        new (new_data.GetAddress() + index) T(std::forward<Args>(args)...);
+
+        try {
+            RelocateWithGap(begin(), size_, index, new_data.GetAddress());
+        } catch (...) {
+            std::destroy_at(new_data.GetAddress() + index);
+            throw;
+        }
+
+        heap_.Swap(new_data);
+        ++size_;
+
+        return begin() + index;
+    }
+
+    // Expects this vector to be empty and able to hold other's elements when other is inline.
+    void StealFrom(SmallVector& other) {
+        if (other.IsInline() || heap_.GetAllocator() != other.heap_.GetAllocator()) {
+            std::uninitialized_move_n(other.begin(), other.size_, begin());
+            size_ = other.size_;
+            other.Clear();
+        } else {
+            heap_.Swap(other.heap_);
+            size_ = std::exchange(other.size_, 0);
+        }
+    }
+
+private:
+    RawMemory<T, Alloc> heap_;
+    size_t size_ = 0;
+    alignas(T) unsigned char inline_[N * sizeof(T)];
+};
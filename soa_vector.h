@@ -0,0 +1,295 @@
+#pragma once
+#include "allocators.h"
+#include "vector.h"
+
+#include <tuple>
+
+// Contiguous view of one column of a SoaVector
+template <typename T>
+class ColumnSpan {
+public:
+    ColumnSpan(T* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    T* begin() const noexcept { return data_; }
+
+    T* end() const noexcept { return data_ + size_; }
+
+    T* Data() const noexcept { return data_; }
+
+    size_t Size() const noexcept { return size_; }
+
+    T& operator[](size_t index) const noexcept { return data_[index]; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Structure-of-arrays sequence: each field of a row is stored in its own cache-line aligned RawMemory, so a
+// scan over one field reads only that field's bytes and compiles to a plain loop over an array. Rows are
+// accessed as tuples of references, e.g. `auto [id, price] = v[i];`.
+template <typename... Fields>
+class SoaVector {
+    static_assert(sizeof...(Fields) > 0, "a row needs at least one field");
+
+public:
+    static constexpr size_t COLUMN_ALIGNMENT = 64;
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    using Row = std::tuple<Fields&...>;
+    using ConstRow = std::tuple<const Fields&...>;
+
+private:
+    template <typename T>
+    using ColumnMemory = RawMemory<T, AlignedAllocator<T, COLUMN_ALIGNMENT>>;
+
+    using Columns = std::tuple<ColumnMemory<Fields>...>;
+    using Indices = std::index_sequence_for<Fields...>;
+
+    // Columns that RelocateN would copy rather than move; they are relocated first, while failure can still
+    // be undone by destroying the copies.
+    template <size_t I>
+    static constexpr bool COPIES_ON_RELOCATE = !IsTriviallyRelocatable<FieldType<I>>::value
+                                               && !std::is_nothrow_move_constructible_v<FieldType<I>>
+                                               && std::is_copy_constructible_v<FieldType<I>>;
+
+public:
+    SoaVector() = default;
+
+    explicit SoaVector(size_t size) : columns_(AllocateColumns(size)), capacity_(size) {
+        ConstructColumns(columns_, 0, size,
+                         [](auto, auto* to, size_t n) { std::uninitialized_value_construct_n(to, n); });
+        size_ = size;
+    }
+
+    SoaVector(const SoaVector& other) : columns_(AllocateColumns(other.size_)), capacity_(other.size_) {
+        ConstructColumns(columns_, 0, other.size_, [&other](auto i, auto* to, size_t n) {
+            std::uninitialized_copy_n(std::get<i>(other.columns_).GetAddress(), n, to);
+        });
+        size_ = other.size_;
+    }
+
+    SoaVector(SoaVector&& other) noexcept
+        : columns_(std::move(other.columns_)),
+          size_(std::exchange(other.size_, 0)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
+
+    SoaVector& operator=(const SoaVector& other) {
+        if (this != &other) {
+            SoaVector temp(other);
+            Swap(temp);
+        }
+        return *this;
+    }
+
+    SoaVector& operator=(SoaVector&& rhs) noexcept {
+        Swap(rhs);
+        return *this;
+    }
+
+    ~SoaVector() { Clear(); }
+
+    size_t Size() const noexcept { return size_; }
+
+    size_t Capacity() const noexcept { return capacity_; }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+
+        Columns new_columns = AllocateColumns(new_capacity);
+        Relocate(columns_, size_, new_columns);
+        columns_ = std::move(new_columns);
+        capacity_ = new_capacity;
+    }
+
+    // New rows are value-initialized
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+
+        if (new_size < size_) {
+            DestroyRows(new_size, size_ - new_size);
+        } else if (new_size > size_) {
+            ConstructColumns(columns_, size_, new_size - size_,
+                             [](auto, auto* to, size_t n) { std::uninitialized_value_construct_n(to, n); });
+        }
+
+        size_ = new_size;
+    }
+
+    // Takes one argument per field; field I is constructed from argument I
+    template <typename... Args>
+    Row EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == sizeof...(Fields), "EmplaceBack takes one argument per field");
+
+        if (size_ == capacity_) {
+            const size_t new_capacity = DoublingGrowth::NextCapacity(size_);
+            Columns new_columns = AllocateColumns(new_capacity);
+
+            // Built before relocation, since args may refer to rows of this vector
+            ConstructRow(new_columns, size_, std::forward<Args>(args)...);
+            try {
+                Relocate(columns_, size_, new_columns);
+            } catch (...) {
+                DestroyRow(new_columns, size_);
+                throw;
+            }
+
+            columns_ = std::move(new_columns);
+            capacity_ = new_capacity;
+        } else {
+            ConstructRow(columns_, size_, std::forward<Args>(args)...);
+        }
+
+        ++size_;
+
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        DestroyRow(columns_, size_);
+    }
+
+    void Clear() noexcept {
+        DestroyRows(0, size_);
+        size_ = 0;
+    }
+
+    void Swap(SoaVector& other) noexcept {
+        columns_.swap(other.columns_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    template <size_t I>
+    ColumnSpan<FieldType<I>> Column() noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    ColumnSpan<const FieldType<I>> Column() const noexcept {
+        return {std::get<I>(columns_).GetAddress(), size_};
+    }
+
+    template <size_t I>
+    FieldType<I>& Get(size_t index) noexcept {
+        return std::get<I>(columns_)[index];
+    }
+
+    template <size_t I>
+    const FieldType<I>& Get(size_t index) const noexcept {
+        return std::get<I>(columns_)[index];
+    }
+
+    Row operator[](size_t index) noexcept { return MakeRow<Row>(columns_, index, Indices{}); }
+
+    ConstRow operator[](size_t index) const noexcept { return MakeRow<ConstRow>(columns_, index, Indices{}); }
+
+private:
+    // Calls f(std::integral_constant<size_t, I>{}) for every column in order
+    template <typename F>
+    static void ForEachColumn(F&& f) {
+        ForEachColumn(std::forward<F>(f), Indices{});
+    }
+
+    template <typename F, size_t... I>
+    static void ForEachColumn(F&& f, std::index_sequence<I...>) {
+        (f(std::integral_constant<size_t, I>{}), ...);
+    }
+
+    template <typename R, typename C, size_t... I>
+    static R MakeRow(C& columns, size_t index, std::index_sequence<I...>) noexcept {
+        return R(std::get<I>(columns)[index]...);
+    }
+
+    static Columns AllocateColumns(size_t capacity) { return Columns(ColumnMemory<Fields>(capacity)...); }
+
+    // Builds [index, index + n) in every column with construct(i, to, n), which must clean up after itself
+    // if it throws, as the std::uninitialized_* algorithms do. The columns built before it are then destroyed.
+    template <typename Construct>
+    static void ConstructColumns(Columns& columns, size_t index, size_t n, Construct construct) {
+        size_t constructed = 0;
+        try {
+            ForEachColumn([&](auto i) {
+                construct(i, std::get<i>(columns).GetAddress() + index, n);
+                ++constructed;
+            });
+        } catch (...) {
+            ForEachColumn([&](auto i) {
+                if (i < constructed) {
+                    std::destroy_n(std::get<i>(columns).GetAddress() + index, n);
+                }
+            });
+            throw;
+        }
+    }
+
+    template <typename... Args>
+    static void ConstructRow(Columns& columns, size_t index, Args&&... args) {
+        auto values = std::forward_as_tuple(std::forward<Args>(args)...);
+        size_t constructed = 0;
+        try {
+            ForEachColumn([&](auto i) {
+                new (std::get<i>(columns).GetAddress() + index) FieldType<i>(std::get<i>(std::move(values)));
+                ++constructed;
+            });
+        } catch (...) {
+            ForEachColumn([&](auto i) {
+                if (i < constructed) {
+                    std::destroy_at(std::get<i>(columns).GetAddress() + index);
+                }
+            });
+            throw;
+        }
+    }
+
+    static void DestroyRow(Columns& columns, size_t index) noexcept {
+        ForEachColumn([&](auto i) { std::destroy_at(std::get<i>(columns).GetAddress() + index); });
+    }
+
+    void DestroyRows(size_t index, size_t n) noexcept {
+        ForEachColumn([&](auto i) { std::destroy_n(std::get<i>(columns_).GetAddress() + index, n); });
+    }
+
+    // Relocates n rows with the strong guarantee. Columns that have to be copied go first, and a failure
+    // among them only destroys the copies; the rest are moved with operations that can't throw.
+    static void Relocate(Columns& from, size_t n, Columns& to) {
+        size_t copied_before = 0;
+        try {
+            ForEachColumn([&](auto i) {
+                if constexpr (COPIES_ON_RELOCATE<i>) {
+                    std::uninitialized_copy_n(std::get<i>(from).GetAddress(), n, std::get<i>(to).GetAddress());
+                    VECTOR_STATS(FieldType<i>, OnCopy(n));
+                    copied_before = i + 1;
+                }
+            });
+        } catch (...) {
+            ForEachColumn([&](auto i) {
+                if constexpr (COPIES_ON_RELOCATE<i>) {
+                    if (i < copied_before) {
+                        std::destroy_n(std::get<i>(to).GetAddress(), n);
+                    }
+                }
+            });
+            throw;
+        }
+
+        ForEachColumn([&](auto i) {
+            if constexpr (COPIES_ON_RELOCATE<i>) {
+                std::destroy_n(std::get<i>(from).GetAddress(), n);
+            } else {
+                RelocateN(std::get<i>(from).GetAddress(), n, std::get<i>(to).GetAddress());
+            }
+        });
+    }
+
+private:
+    Columns columns_;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
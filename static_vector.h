@@ -0,0 +1,196 @@
+#pragma once
+#include "vector.h"
+
+#include <new>
+
+// Vector with room for exactly N elements in inline storage. It never allocates: growing past N throws
+// std::bad_alloc and leaves the vector unchanged, as std::inplace_vector does.
+template <typename T, size_t N>
+class StaticVector {
+    static_assert(N > 0, "a StaticVector needs room for at least one element");
+
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    explicit StaticVector(size_t size) {
+        CheckCapacity(size);
+        std::uninitialized_value_construct_n(begin(), size);
+        size_ = size;
+    }
+
+    StaticVector(const StaticVector& other) {
+        std::uninitialized_copy_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<T>) {
+        std::uninitialized_move_n(other.begin(), other.size_, begin());
+        size_ = other.size_;
+    }
+
+    StaticVector& operator=(const StaticVector& other) {
+        if (this != &other) {
+            Assign(other.begin(), other.size_);
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<T>
+                                                         && std::is_nothrow_move_assignable_v<T>) {
+        if (this != &rhs) {
+            Assign(std::make_move_iterator(rhs.begin()), rhs.size_);
+        }
+        return *this;
+    }
+
+    ~StaticVector() { std::destroy_n(begin(), size_); }
+
+    iterator begin() noexcept { return Data(); }
+
+    iterator end() noexcept { return Data() + size_; }
+
+    const_iterator begin() const noexcept { return Data(); }
+
+    const_iterator end() const noexcept { return Data() + size_; }
+
+    const_iterator cbegin() const noexcept { return Data(); }
+
+    const_iterator cend() const noexcept { return Data() + size_; }
+
+    size_t Size() const noexcept { return size_; }
+
+    static constexpr size_t Capacity() noexcept { return N; }
+
+    void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+
+        if (new_size < size_) {
+            std::destroy_n(begin() + new_size, size_ - new_size);
+        } else if (new_size > size_) {
+            std::uninitialized_default_construct_n(end(), new_size - size_);
+        }
+
+        size_ = new_size;
+    }
+
+    template <typename U>
+    void PushBack(U&& value) {
+        EmplaceBack(std::forward<U>(value));
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        std::destroy_at(end());
+    }
+
+    template <typename... Args>
+    T& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+
+        new (end()) T(std::forward<Args>(args)...);
+        ++size_;
+
+        return begin()[size_ - 1];
+    }
+
+    iterator Insert(const_iterator pos, const T& value) { return Emplace(pos, value); }
+
+    iterator Insert(const_iterator pos, T&& value) { return Emplace(pos, std::move(value)); }
+
+    template <typename... Args>
+    iterator Emplace(const_iterator p, Args&&... args) {
+        const size_t dist = p - cbegin();
+        CheckCapacity(size_ + 1);
+
+        if (dist == size_) {
+            new (end()) T(std::forward<Args>(args)...);
+        } else {
+            T temp(std::forward<Args>(args)...);
+            new (end()) T(std::move(*(end() - 1)));
+            std::move_backward(begin() + dist, end() - 1, end());
+            begin()[dist] = std::move(temp);
+        }
+
+        ++size_;
+
+        return begin() + dist;
+    }
+
+    iterator Erase(const_iterator p) {
+        iterator pos = begin() + (p - cbegin());
+
+        if (begin() == end()) {
+            return pos;
+        }
+
+        std::move(pos + 1, end(), pos);
+        PopBack();
+
+        return pos;
+    }
+
+    iterator Erase(const_iterator first, const_iterator last) {
+        iterator pos = begin() + (first - cbegin());
+        const size_t count = last - first;
+        if (count == 0) {
+            return pos;
+        }
+
+        iterator new_end = std::move(pos + count, end(), pos);
+        std::destroy(new_end, end());
+        size_ -= count;
+
+        return pos;
+    }
+
+    void Clear() noexcept {
+        std::destroy_n(begin(), size_);
+        size_ = 0;
+    }
+
+    void Swap(StaticVector& other) noexcept(std::is_nothrow_move_constructible_v<T>
+                                            && std::is_nothrow_move_assignable_v<T>) {
+        StaticVector temp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(temp);
+    }
+
+    const T& operator[](size_t index) const noexcept { return Data()[index]; }
+
+    T& operator[](size_t index) noexcept { return Data()[index]; }
+
+private:
+    static void CheckCapacity(size_t size) {
+        if (size > N) {
+            throw std::bad_alloc();
+        }
+    }
+
+    T* Data() noexcept { return reinterpret_cast<T*>(storage_); }
+
+    const T* Data() const noexcept { return reinterpret_cast<const T*>(storage_); }
+
+    // Assigns over the common prefix and constructs or destroys the rest
+    template <typename It>
+    void Assign(It source, size_t n) {
+        const size_t common = std::min(size_, n);
+        std::copy_n(source, common, begin());
+
+        if (size_ > n) {
+            std::destroy_n(begin() + n, size_ - n);
+        } else if (size_ < n) {
+            std::uninitialized_copy_n(source + common, n - common, end());
+        }
+
+        size_ = n;
+    }
+
+private:
+    size_t size_ = 0;
+    alignas(T) unsigned char storage_[N * sizeof(T)];
+};
@@ -1,91 +1,740 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <memory_resource>
 #include <new>
 #include <utility>
 
+#include "vector_hints.h"
+#include "vector_pool.h"
+#include "vector_simd.h"
+#include "vector_stats.h"
+
+// Under C++20 Vector can be created, grown and destroyed during constant evaluation, as std::vector can.
+// Operations that work on raw bytes fall back to element-wise loops there. Only the vectorized scans (Find,
+// Count, Fill, Sum, Min, Max) and growth through an allocator's reallocate are left to run time.
+#if __cplusplus >= 202002L
+#define VECTOR_CONSTEXPR constexpr
+#else
+#define VECTOR_CONSTEXPR
+#endif
+
+// Keeps rarely taken slow paths, such as reallocation on append, out of line so that the inlined fast path
+// stays small enough for callers' loops to be unrolled
+#if defined(__GNUC__)
+#define VECTOR_COLD [[gnu::cold, gnu::noinline]]
+#else
+#define VECTOR_COLD
+#endif
+
+constexpr bool IsConstantEvaluated() noexcept {
+#if __cplusplus >= 202002L
+    return std::is_constant_evaluated();
+#else
+    return false;
+#endif
+}
+
+// Placement new isn't allowed in constant evaluation, std::construct_at is
+template <typename T, typename... Args>
+VECTOR_CONSTEXPR T* ConstructAt(T* p, Args&&... args) {
+#if __cplusplus >= 202002L
+    return std::construct_at(p, std::forward<Args>(args)...);
+#else
+    return new (p) T(std::forward<Args>(args)...);
+#endif
+}
+
+// Checks against misuse of Vector, selected with VECTOR_HARDENING (the same in every translation unit):
+//   0 - none, the default;
+//   1 - bounds: operator[], PopBack and positions passed to Insert, Emplace and Erase are checked;
+//   2 - iterators as well: they remember the generation of the buffer they were made for, and every
+//       reallocation starts a new one, so iterators invalidated by growth are caught when used.
+// With VECTOR_HARDENING_SAMPLE_PERIOD = N only every Nth Vector created on a thread is checked; the others
+// pay for a predicted branch per check. A failed check calls the handler installed with SetHandler.
+#ifndef VECTOR_HARDENING
+#define VECTOR_HARDENING 0
+#endif
+
+#ifndef VECTOR_HARDENING_SAMPLE_PERIOD
+#define VECTOR_HARDENING_SAMPLE_PERIOD 1
+#endif
+
+namespace hardening {
+
+inline constexpr bool BOUNDS = VECTOR_HARDENING >= 1;
+inline constexpr bool ITERATORS = VECTOR_HARDENING >= 2;
+inline constexpr size_t SAMPLE_PERIOD = VECTOR_HARDENING_SAMPLE_PERIOD;
+
+static_assert(VECTOR_HARDENING >= 0 && VECTOR_HARDENING <= 2, "VECTOR_HARDENING must be 0, 1 or 2");
+static_assert(SAMPLE_PERIOD > 0, "VECTOR_HARDENING_SAMPLE_PERIOD must be positive");
+
+using Handler = void (*)(const char* what);
+
+[[noreturn]] inline void Abort(const char* what) noexcept {
+    std::fprintf(stderr, "Vector check failed: %s\n", what);
+    std::abort();
+}
+
+inline std::atomic<Handler> handler{Abort};
+
+// Returns the previous handler. A handler may throw, and the failed operation then has no effect; if it
+// returns, the program is aborted.
+inline Handler SetHandler(Handler new_handler) noexcept { return handler.exchange(new_handler); }
+
+VECTOR_COLD inline void Fail(const char* what) {
+    handler.load(std::memory_order_relaxed)(what);
+    std::abort();
+}
+
+// Per-vector part of the checks: whether the vector was sampled and the generation of its buffer. Vector
+// derives from it, so it takes no space when hardening is off.
+template <bool Enabled = BOUNDS>
+class State {
+public:
+    constexpr bool IsSampled() const noexcept { return false; }
+
+    constexpr uint64_t Generation() const noexcept { return 0; }
+
+    constexpr void NextGeneration() noexcept {}
+};
+
+template <>
+class State<true> {
+public:
+    VECTOR_CONSTEXPR State() noexcept : sampled_(SAMPLE_PERIOD == 1 || IsConstantEvaluated() || Sample()) {}
+
+    // A copy is sampled on its own and counts its own generations
+    VECTOR_CONSTEXPR State(const State&) noexcept : State() {}
+
+    VECTOR_CONSTEXPR State& operator=(const State&) noexcept { return *this; }
+
+    constexpr bool IsSampled() const noexcept { return SAMPLE_PERIOD == 1 || sampled_; }
+
+    constexpr uint64_t Generation() const noexcept { return generation_; }
+
+    VECTOR_CONSTEXPR void NextGeneration() noexcept { ++generation_; }
+
+private:
+    static bool Sample() noexcept {
+        static thread_local size_t created = 0;
+        return created++ % SAMPLE_PERIOD == 0;
+    }
+
+    bool sampled_;
+    uint64_t generation_ = 0;
+};
+
+// Iterator of a checked Vector. It is checked against the generation of the vector's buffer whenever it is
+// dereferenced or converted to a pointer, and it converts to a pointer implicitly, as Vector iterators are
+// plain pointers otherwise. It refers to the vector object it came from, so it must not outlive it.
 template <typename T>
-class RawMemory {
+class CheckedIterator {
 public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_cv_t<T>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T*;
+    using reference = T&;
+
+    CheckedIterator() = default;
+
+    // A null state makes an iterator that isn't checked, for vectors that weren't sampled
+    constexpr CheckedIterator(T* ptr, const State<true>* state) noexcept
+        : ptr_(ptr), state_(state), generation_(state != nullptr ? state->Generation() : 0) {}
+
+    template <typename U, typename = std::enable_if_t<std::is_same_v<const U, T> && !std::is_same_v<U, T>>>
+    constexpr CheckedIterator(const CheckedIterator<U>& other) noexcept
+        : ptr_(other.ptr_), state_(other.state_), generation_(other.generation_) {}
+
+    constexpr operator T*() const {
+        Check();
+        return ptr_;
+    }
+
+    constexpr T& operator*() const {
+        Check();
+        return *ptr_;
+    }
+
+    constexpr T* operator->() const {
+        Check();
+        return ptr_;
+    }
+
+    constexpr T& operator[](difference_type n) const {
+        Check();
+        return ptr_[n];
+    }
+
+    constexpr bool IsValid() const noexcept { return state_ == nullptr || state_->Generation() == generation_; }
+
+    // The pointer and the vector it belongs to, without checks
+    constexpr T* Base() const noexcept { return ptr_; }
+
+    constexpr const State<true>* Owner() const noexcept { return state_; }
+
+    constexpr CheckedIterator& operator++() noexcept {
+        ++ptr_;
+        return *this;
+    }
+
+    constexpr CheckedIterator operator++(int) noexcept {
+        CheckedIterator old = *this;
+        ++ptr_;
+        return old;
+    }
+
+    constexpr CheckedIterator& operator--() noexcept {
+        --ptr_;
+        return *this;
+    }
+
+    constexpr CheckedIterator operator--(int) noexcept {
+        CheckedIterator old = *this;
+        --ptr_;
+        return old;
+    }
+
+    constexpr CheckedIterator& operator+=(difference_type n) noexcept {
+        ptr_ += n;
+        return *this;
+    }
+
+    constexpr CheckedIterator& operator-=(difference_type n) noexcept {
+        ptr_ -= n;
+        return *this;
+    }
+
+    constexpr CheckedIterator operator+(difference_type n) const noexcept { return CheckedIterator(*this) += n; }
+
+    constexpr CheckedIterator operator-(difference_type n) const noexcept { return CheckedIterator(*this) -= n; }
+
+    friend constexpr CheckedIterator operator+(difference_type n, const CheckedIterator& it) noexcept {
+        return it + n;
+    }
+
+    friend constexpr difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ - rhs.ptr_;
+    }
+
+    friend constexpr bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ == rhs.ptr_;
+    }
+
+    friend constexpr bool operator!=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ != rhs.ptr_;
+    }
+
+    friend constexpr bool operator<(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ < rhs.ptr_;
+    }
+
+    friend constexpr bool operator>(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ > rhs.ptr_;
+    }
+
+    friend constexpr bool operator<=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ <= rhs.ptr_;
+    }
+
+    friend constexpr bool operator>=(const CheckedIterator& lhs, const CheckedIterator& rhs) noexcept {
+        return lhs.ptr_ >= rhs.ptr_;
+    }
+
+private:
+    template <typename U>
+    friend class CheckedIterator;
+
+    constexpr void Check() const {
+        if (!IsValid()) [[unlikely]] {
+            Fail("iterator invalidated by reallocation");
+        }
+    }
+
+    T* ptr_ = nullptr;
+    const State<true>* state_ = nullptr;
+    uint64_t generation_ = 0;
+};
+
+}  // namespace hardening
+
+// A type is trivially relocatable when moving an object to new storage and ending the lifetime of the
+// source is equivalent to copying its bytes. Specialize for owning handles such as std::unique_ptr.
+template <typename T>
+struct IsTriviallyRelocatable : std::is_trivially_copyable<T> {};
+
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<std::unique_ptr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
+// The std::uninitialized_* algorithms aren't constexpr before C++26, so constant evaluation uses these loops.
+// Nothing can throw there, so they don't need to clean up after a failure.
+template <typename T, typename Source>
+constexpr void ConstantConstructN(T* to, size_t n, Source source) {
+    for (size_t i = 0; i < n; ++i) {
+        ConstructAt(to + i, source(i));
+    }
+}
+
+// Moves elements when that can't throw (or copying is impossible) and copies them otherwise, so that
+// callers can give the strong guarantee by leaving the source untouched on failure.
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveOrCopyN(T* from, size_t n, T* to) {
+    constexpr bool MOVES = std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>;
+
+    if (IsConstantEvaluated()) {
+        ConstantConstructN(to, n, [from](size_t i) -> decltype(auto) {
+            if constexpr (MOVES) {
+                return std::move(from[i]);
+            } else {
+                return static_cast<const T&>(from[i]);
+            }
+        });
+    } else if constexpr (MOVES) {
+        std::uninitialized_move_n(from, n, to);
+        VECTOR_STATS(T, OnRelocate(n));
+    } else {
+        std::uninitialized_copy_n(from, n, to);
+        VECTOR_STATS(T, OnCopy(n));
+    }
+}
+
+template <typename InputIt, typename T>
+VECTOR_CONSTEXPR void UninitializedCopyN(InputIt from, size_t n, T* to) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i, ++from) {
+            ConstructAt(to + i, *from);
+        }
+    } else {
+        std::uninitialized_copy_n(from, n, to);
+    }
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedMoveN(T* from, size_t n, T* to) {
+    if (IsConstantEvaluated()) {
+        ConstantConstructN(to, n, [from](size_t i) -> T&& { return std::move(from[i]); });
+    } else {
+        std::uninitialized_move_n(from, n, to);
+    }
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedFillN(T* to, size_t n, const T& value) {
+    if (IsConstantEvaluated()) {
+        ConstantConstructN(to, n, [&value](size_t) -> const T& { return value; });
+    } else {
+        std::uninitialized_fill_n(to, n, value);
+    }
+}
+
+// Default-initializes elements at run time. Constant evaluation can't leave them indeterminate, so there
+// they are value-initialized.
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedDefaultConstructN(T* to, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(to + i);
+        }
+    } else {
+        std::uninitialized_default_construct_n(to, n);
+    }
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void UninitializedValueConstructN(T* to, size_t n) {
+    if (IsConstantEvaluated()) {
+        for (size_t i = 0; i < n; ++i) {
+            ConstructAt(to + i);
+        }
+    } else {
+        std::uninitialized_value_construct_n(to, n);
+    }
+}
+
+template <typename T>
+void RelocateBytes(T* from, size_t n, T* to) noexcept {
+    // An empty vector has no buffer, and memcpy must not be given a null pointer even for zero bytes
+    if (n == 0 || from == nullptr || to == nullptr) {
+        return;
+    }
+    std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+    VECTOR_STATS(T, OnRelocate(n));
+}
+
+template <typename T>
+VECTOR_CONSTEXPR void CopyBytes(const T* from, size_t n, T* to) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (IsConstantEvaluated()) {
+        UninitializedCopyN(from, n, to);
+    } else if (n != 0 && from != nullptr && to != nullptr) {
+        std::memcpy(static_cast<void*>(to), static_cast<const void*>(from), n * sizeof(T));
+    }
+}
+
+// Moves n elements into uninitialized memory and ends their lifetime at the source. Gives the strong
+// guarantee: if a copy throws, the source is left untouched.
+template <typename T>
+VECTOR_CONSTEXPR void RelocateN(T* from, size_t n, T* to) {
+    if (n != 0) {
+        VECTOR_STATS(T, OnReallocate());
+    }
+
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (!IsConstantEvaluated()) {
+            RelocateBytes(from, n, to);
+            return;
+        }
+    }
+
+    UninitializedMoveOrCopyN(from, n, to);
+    std::destroy_n(from, n);
+}
+
+// Same as RelocateN, but leaves gap_size uninitialized slots at `to + gap` for inserted elements.
+template <typename T>
+VECTOR_CONSTEXPR void RelocateWithGap(T* from, size_t n, size_t gap, T* to, size_t gap_size = 1) {
+    if (n != 0) {
+        VECTOR_STATS(T, OnReallocate());
+    }
+
+    if constexpr (IsTriviallyRelocatable<T>::value) {
+        if (!IsConstantEvaluated()) {
+            RelocateBytes(from, gap, to);
+            RelocateBytes(from + gap, n - gap, to + gap + gap_size);
+            return;
+        }
+    }
+
+    UninitializedMoveOrCopyN(from, gap, to);
+    try {
+        UninitializedMoveOrCopyN(from + gap, n - gap, to + gap + gap_size);
+    } catch (...) {
+        std::destroy_n(to, gap);
+        throw;
+    }
+    std::destroy_n(from, n);
+}
+
+// Allocators may provide `T* reallocate(T* p, size_t old_n, size_t new_n)` that resizes a block, possibly
+// moving its bytes (like std::realloc). Vector uses it to grow buffers of trivially relocatable elements.
+template <typename Alloc, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Alloc>
+struct HasReallocate<Alloc, std::void_t<decltype(std::declval<Alloc&>().reallocate(
+                                std::declval<typename Alloc::value_type*>(), size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Allocators may also provide `allocate_at_least(n)` returning {pointer, count} with count >= n, as in
+// C++23. RawMemory then reports the whole usable block as its capacity.
+template <typename Alloc, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Alloc>
+struct HasAllocateAtLeast<Alloc, std::void_t<decltype(std::declval<Alloc&>().allocate_at_least(size_t{}))>>
+    : std::true_type {};
+
+// Keeps the allocator of RawMemory. An empty allocator is stored as a base, so that it takes no space.
+template <typename Alloc, bool = std::is_empty_v<Alloc> && !std::is_final_v<Alloc>>
+class AllocatorHolder {
+protected:
+    AllocatorHolder() = default;
+
+    VECTOR_CONSTEXPR explicit AllocatorHolder(const Alloc& alloc) noexcept : alloc_(alloc) {}
+
+    VECTOR_CONSTEXPR Alloc& Allocator() noexcept { return alloc_; }
+
+    VECTOR_CONSTEXPR const Alloc& Allocator() const noexcept { return alloc_; }
+
+private:
+    Alloc alloc_;
+};
+
+template <typename Alloc>
+class AllocatorHolder<Alloc, true> : private Alloc {
+protected:
+    AllocatorHolder() = default;
+
+    VECTOR_CONSTEXPR explicit AllocatorHolder(const Alloc& alloc) noexcept : Alloc(alloc) {}
+
+    VECTOR_CONSTEXPR Alloc& Allocator() noexcept { return *this; }
+
+    VECTOR_CONSTEXPR const Alloc& Allocator() const noexcept { return *this; }
+};
+
+template <typename T, typename Alloc = std::allocator<T>>
+class RawMemory : private AllocatorHolder<Alloc> {
+    using AllocTraits = std::allocator_traits<Alloc>;
+    using Holder = AllocatorHolder<Alloc>;
+    using Holder::Allocator;
+
+public:
+    using allocator_type = Alloc;
+
     RawMemory(const RawMemory&) = delete;
 
     RawMemory& operator=(const RawMemory&) = delete;
 
     RawMemory() = default;
 
-    explicit RawMemory(size_t capacity) : buffer_(Allocate(capacity)), capacity_(capacity) {}
+    VECTOR_CONSTEXPR explicit RawMemory(const Alloc& alloc) noexcept : Holder(alloc) {}
+
+    VECTOR_CONSTEXPR explicit RawMemory(size_t capacity, const Alloc& alloc = Alloc()) : Holder(alloc) {
+        Allocate(capacity);
+    }
 
-    RawMemory(RawMemory&& other) noexcept { Swap(other); }
+    VECTOR_CONSTEXPR RawMemory(RawMemory&& other) noexcept
+        : Holder(other.Allocator()),
+          buffer_(std::exchange(other.buffer_, nullptr)),
+          capacity_(std::exchange(other.capacity_, 0)) {}
 
-    RawMemory& operator=(RawMemory&& other) noexcept {
+    VECTOR_CONSTEXPR RawMemory& operator=(RawMemory&& other) noexcept {
         Swap(other);
         return *this;
     }
 
-    ~RawMemory() { Deallocate(buffer_); }
+    VECTOR_CONSTEXPR ~RawMemory() { Deallocate(buffer_, capacity_); }
 
-    T* operator+(size_t offset) noexcept { return buffer_ + offset; }
+    VECTOR_CONSTEXPR T* operator+(size_t offset) noexcept { return buffer_ + offset; }
 
-    const T* operator+(size_t offset) const noexcept { return buffer_ + offset; }
+    VECTOR_CONSTEXPR const T* operator+(size_t offset) const noexcept { return buffer_ + offset; }
 
-    T& operator[](size_t index) noexcept { return buffer_[index]; }
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept { return buffer_[index]; }
 
-    const T& operator[](size_t index) const noexcept { return buffer_[index]; }
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept { return buffer_[index]; }
 
-    void Swap(RawMemory& other) noexcept {
+    // Allocators are exchanged only when they propagate on swap; otherwise both sides must share an
+    // allocator, which is how Vector creates every temporary buffer.
+    VECTOR_CONSTEXPR void Swap(RawMemory& other) noexcept {
         std::swap(buffer_, other.buffer_);
         std::swap(capacity_, other.capacity_);
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(Allocator(), other.Allocator());
+        }
     }
 
-    const T* GetAddress() const noexcept { return buffer_; }
+    VECTOR_CONSTEXPR const T* GetAddress() const noexcept { return buffer_; }
+
+    VECTOR_CONSTEXPR T* GetAddress() noexcept { return buffer_; }
+
+    VECTOR_CONSTEXPR size_t Capacity() const { return capacity_; }
 
-    T* GetAddress() noexcept { return buffer_; }
+    VECTOR_CONSTEXPR const Alloc& GetAllocator() const noexcept { return Allocator(); }
 
-    size_t Capacity() const { return capacity_; }
+    // Bytes of the buffer are preserved up to the smaller of the two capacities, so this is only meaningful
+    // for trivially relocatable T. The buffer is left untouched if the allocator throws.
+    void Reallocate(size_t new_capacity) {
+        static_assert(HasReallocate<Alloc>::value, "allocator doesn't support reallocate");
+        buffer_ = Allocator().reallocate(buffer_, capacity_, new_capacity);
+        VECTOR_STATS(T, OnAllocate(new_capacity));
+        if (capacity_ != 0) {
+            VECTOR_STATS(T, OnReallocate());
+            VECTOR_STATS(T, OnDeallocate());
+        }
+        capacity_ = new_capacity;
+    }
 
 private:
-    static T* Allocate(size_t n) { return n != 0 ? static_cast<T*>(operator new(n * sizeof(T))) : nullptr; }
+    VECTOR_CONSTEXPR void Allocate(size_t n) {
+        if (n == 0) {
+            return;
+        }
+
+        if constexpr (vector_pool::IS_POOLED<T, Alloc>) {
+            if (!IsConstantEvaluated()) {
+                if (n > AllocTraits::max_size(Allocator())) {
+                    throw std::bad_array_new_length();
+                }
+                // Capacity stays n, so that Deallocate finds the same class
+                buffer_ = static_cast<T*>(vector_pool::Allocate(vector_pool::ClassBytes(n * sizeof(T))));
+                capacity_ = n;
+                VECTOR_STATS(T, OnAllocate(capacity_));
+                return;
+            }
+        }
+
+        if constexpr (HasAllocateAtLeast<Alloc>::value) {
+            auto [ptr, count] = Allocator().allocate_at_least(n);
+            buffer_ = ptr;
+            capacity_ = count;
+        } else {
+            buffer_ = AllocTraits::allocate(Allocator(), n);
+            capacity_ = n;
+        }
+
+        VECTOR_STATS(T, OnAllocate(capacity_));
+    }
+
+    VECTOR_CONSTEXPR void Deallocate(T* buf, size_t n) noexcept {
+        if (buf == nullptr) {
+            return;
+        }
 
-    static void Deallocate(T* buf) noexcept { operator delete(buf); }
+        if constexpr (vector_pool::IS_POOLED<T, Alloc>) {
+            if (!IsConstantEvaluated()) {
+                vector_pool::Deallocate(buf, vector_pool::ClassBytes(n * sizeof(T)));
+                VECTOR_STATS(T, OnDeallocate());
+                return;
+            }
+        }
+
+        AllocTraits::deallocate(Allocator(), buf, n);
+        VECTOR_STATS(T, OnDeallocate());
+    }
 
 private:
     T* buffer_ = nullptr;
     size_t capacity_ = 0;
 };
 
-template <typename T>
-class Vector {
+template <typename It>
+using RequireInputIterator = std::enable_if_t<
+    std::is_convertible_v<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>>;
+
+// Growth policies compute the capacity a full vector of `size` elements reallocates to.
+struct DoublingGrowth {
+    static constexpr size_t NextCapacity(size_t size) noexcept { return size == 0 ? 1 : size * 2; }
+};
+
+// A factor below the golden ratio lets a sequence of reallocations reuse previously freed blocks.
+struct OneAndHalfGrowth {
+    static constexpr size_t NextCapacity(size_t size) noexcept { return size <= 1 ? size + 1 : size + size / 2; }
+};
+
+// Skips the 1, 2, 4, ... reallocation chain of small vectors by starting at MinCapacity.
+template <size_t MinCapacity, typename Growth = DoublingGrowth>
+struct MinCapacityGrowth {
+    static constexpr size_t NextCapacity(size_t size) noexcept {
+        return std::max(MinCapacity, Growth::NextCapacity(size));
+    }
+};
+
+// Growth policies may also define ShrinkCapacity(size, capacity), which PopBack and Erase use to give memory
+// back. Returning capacity keeps the buffer.
+template <typename Growth, typename = void>
+struct HasShrinkCapacity : std::false_type {};
+
+template <typename Growth>
+struct HasShrinkCapacity<Growth, std::void_t<decltype(Growth::ShrinkCapacity(size_t{}, size_t{}))>>
+    : std::true_type {};
+
+// Shrinks to twice the size once a vector is at most 1/Divisor full. The gap between the two thresholds
+// keeps pushes and pops around a boundary from reallocating every time.
+template <size_t Divisor = 4, typename Growth = DoublingGrowth>
+struct ShrinkingGrowth {
+    static_assert(Divisor > 2, "shrinking to twice the size must leave the vector below the threshold");
+
+    static constexpr size_t NextCapacity(size_t size) noexcept { return Growth::NextCapacity(size); }
+
+    static constexpr size_t ShrinkCapacity(size_t size, size_t capacity) noexcept {
+        return size > capacity / Divisor ? capacity : std::max<size_t>(size * 2, 1);
+    }
+};
+
+template <typename T, typename Alloc = std::allocator<T>, typename Growth = DoublingGrowth>
+class Vector : private hardening::State<>, private capacity_hints::Tracker {
+    using AllocTraits = std::allocator_traits<Alloc>;
+
+    static constexpr bool GROWS_IN_PLACE = IsTriviallyRelocatable<T>::value && HasReallocate<Alloc>::value;
+
 public:
-    using iterator = T*;
-    using const_iterator = const T*;
+    using value_type = T;
+    using iterator = std::conditional_t<hardening::ITERATORS, hardening::CheckedIterator<T>, T*>;
+    using const_iterator = std::conditional_t<hardening::ITERATORS, hardening::CheckedIterator<const T>, const T*>;
+    using allocator_type = Alloc;
+
+    // Appends into capacity reserved by ReserveBack
+    class BackCursor {
+    public:
+        BackCursor(const BackCursor&) = delete;
+
+        BackCursor& operator=(const BackCursor&) = delete;
+
+        VECTOR_CONSTEXPR ~BackCursor() { vector_.size_ = end_ - vector_.Data(); }
+
+        template <typename... Args>
+        VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
+            assert(end_ != limit_);
+            ConstructAt(end_, std::forward<Args>(args)...);
+            return *end_++;
+        }
+
+        template <typename U>
+        VECTOR_CONSTEXPR void PushBack(U&& value) {
+            EmplaceBack(std::forward<U>(value));
+        }
+
+        // Number of elements that can still be appended
+        VECTOR_CONSTEXPR size_t Room() const noexcept { return limit_ - end_; }
 
-    Vector() = default;
+    private:
+        friend class Vector;
 
-    explicit Vector(size_t size) : data_(size), size_(size) {
-        std::uninitialized_value_construct_n(data_.GetAddress(), size_);
+        VECTOR_CONSTEXPR explicit BackCursor(Vector& vector) noexcept
+            : vector_(vector), end_(vector.Data() + vector.size_), limit_(vector.Data() + vector.Capacity()) {}
+
+        Vector& vector_;
+        T* end_;
+        T* limit_;
+    };
+
+    // The call site only matters with VECTOR_ENABLE_CAPACITY_HINTS, see vector_hints.h
+    VECTOR_CONSTEXPR Vector(capacity_hints::CallSite site = VECTOR_CURRENT_CALL_SITE) noexcept : Tracker(site) {}
+
+    VECTOR_CONSTEXPR explicit Vector(const Alloc& alloc,
+                                     capacity_hints::CallSite site = VECTOR_CURRENT_CALL_SITE) noexcept
+        : Tracker(site), data_(alloc) {}
+
+    VECTOR_CONSTEXPR explicit Vector(size_t size, const Alloc& alloc = Alloc(),
+                                     capacity_hints::CallSite site = VECTOR_CURRENT_CALL_SITE)
+        : Tracker(site), data_(size, alloc), size_(size) {
+        UninitializedValueConstructN(data_.GetAddress(), size_);
     }
 
-    Vector(const Vector& other) : data_(other.size_), size_(other.size_) {
-        std::uninitialized_copy_n(other.data_.GetAddress(), size_, data_.GetAddress());
+    VECTOR_CONSTEXPR Vector(const Vector& other)
+        : Vector(other, AllocTraits::select_on_container_copy_construction(other.data_.GetAllocator())) {}
+
+    VECTOR_CONSTEXPR Vector(const Vector& other, const Alloc& alloc)
+        : Tracker(other), data_(other.size_, alloc), size_(other.size_) {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            CopyBytes(other.data_.GetAddress(), size_, data_.GetAddress());
+        } else {
+            UninitializedCopyN(other.data_.GetAddress(), size_, data_.GetAddress());
+        }
     }
 
-    Vector(Vector&& other) noexcept { Swap(other); }
+    VECTOR_CONSTEXPR Vector(Vector&& other) noexcept
+        : Tracker(std::move(other)), data_(std::move(other.data_)), size_(std::exchange(other.size_, 0)) {}
 
-    Vector& operator=(const Vector& other) {
+    VECTOR_CONSTEXPR Vector& operator=(const Vector& other) {
         if (other.size_ > data_.Capacity()) {
-            Vector temp(other);
+            Vector temp(other, data_.GetAllocator());
             Swap(temp);
+            NextGeneration();
 
+        } else if constexpr (std::is_trivially_copyable_v<T>) {
+            // Trivially copyable types are also trivially destructible, so the old elements are just overwritten
+            if (this != &other) {
+                CopyBytes(other.data_.GetAddress(), other.size_, data_.GetAddress());
+            }
         } else {
             std::copy_n(other.data_.GetAddress(), std::min(Size(), other.Size()), data_.GetAddress());
 
             if (Size() > other.Size()) {
                 std::destroy_n(data_ + other.Size(), Size() - other.Size());
             } else if (Size() < other.Size()) {
-                std::uninitialized_copy_n(other.data_.GetAddress() + Size(), other.Size() - Size(),
-                                          data_.GetAddress() + Size());
+                UninitializedCopyN(other.data_.GetAddress() + Size(), other.Size() - Size(),
+                                   data_.GetAddress() + Size());
             }
         }
 
@@ -94,187 +743,664 @@ public:
         return *this;
     }
 
-    Vector& operator=(Vector&& rhs) noexcept {
-        Swap(rhs);
+    VECTOR_CONSTEXPR Vector& operator=(Vector&& rhs) noexcept(AllocTraits::is_always_equal::value
+                                                              || AllocTraits::propagate_on_container_swap::value) {
+        if constexpr (AllocTraits::is_always_equal::value || AllocTraits::propagate_on_container_swap::value) {
+            Swap(rhs);
+        } else if (data_.GetAllocator() == rhs.data_.GetAllocator()) {
+            Swap(rhs);
+        } else {
+            // Storage of rhs can't be adopted, so its elements are moved into memory of our own allocator
+            Vector temp(data_.GetAllocator());
+            temp.Reserve(rhs.size_);
+            std::uninitialized_move_n(rhs.data_.GetAddress(), rhs.size_, temp.data_.GetAddress());
+            temp.size_ = rhs.size_;
+            Swap(temp);
+        }
+        NextGeneration();
+        // rhs is left with our old elements, which say nothing about its call site
+        rhs.StopRecording();
         return *this;
     }
 
-    ~Vector() { std::destroy_n(data_.GetAddress(), size_); };
+    VECTOR_CONSTEXPR ~Vector() {
+        Record(size_);
+        std::destroy_n(data_.GetAddress(), size_);
+    };
+
+    VECTOR_CONSTEXPR iterator begin() noexcept { return MakeIterator(Data()); };
+
+    VECTOR_CONSTEXPR iterator end() noexcept { return MakeIterator(Data() + size_); };
 
-    iterator begin() noexcept { return data_.GetAddress(); };
+    VECTOR_CONSTEXPR const_iterator begin() const noexcept { return MakeIterator(Data()); };
 
-    iterator end() noexcept { return data_.GetAddress() + size_; };
+    VECTOR_CONSTEXPR const_iterator end() const noexcept { return MakeIterator(Data() + size_); };
 
-    const_iterator begin() const noexcept { return data_.GetAddress(); };
+    VECTOR_CONSTEXPR const_iterator cbegin() const noexcept { return begin(); };
 
-    const_iterator end() const noexcept { return data_.GetAddress() + size_; };
+    VECTOR_CONSTEXPR const_iterator cend() const noexcept { return end(); };
 
-    const_iterator cbegin() const noexcept { return data_.GetAddress(); };
+    // The elements as a plain array, which is never checked
+    VECTOR_CONSTEXPR T* Data() noexcept { return data_.GetAddress(); }
 
-    const_iterator cend() const noexcept { return data_.GetAddress() + size_; };
+    VECTOR_CONSTEXPR const T* Data() const noexcept { return data_.GetAddress(); }
 
-    void Reserve(size_t new_capacity) {
+    VECTOR_CONSTEXPR void Reserve(size_t new_capacity) {
         if (new_capacity <= data_.Capacity()) {
             return;
         }
 
-        RawMemory<T> new_data(new_capacity);
+        ChangeCapacity(new_capacity);
+    }
 
-        MoveDataIfPossibleOrCopyInstead(data_.GetAddress(), Size(), new_data.GetAddress());
+    VECTOR_CONSTEXPR void ShrinkToFit() {
+        if (size_ < data_.Capacity()) {
+            ChangeCapacity(size_);
+        }
+    }
 
+    VECTOR_CONSTEXPR void Clear() noexcept {
         std::destroy_n(data_.GetAddress(), size_);
-        data_.Swap(new_data);
+        size_ = 0;
     }
 
-    void Resize(size_t new_size) {
+    // Destroys all elements and frees the buffer.
+    VECTOR_CONSTEXPR void ReleaseMemory() noexcept {
+        Clear();
+        RawMemory<T, Alloc> empty(data_.GetAllocator());
+        data_.Swap(empty);
+        NextGeneration();
+    }
+
+    VECTOR_CONSTEXPR void Resize(size_t new_size) {
         Reserve(new_size);
 
         if (new_size < size_) {
             std::destroy_n(data_ + new_size, size_ - new_size);
         } else if (new_size > size_) {
-            std::uninitialized_default_construct_n(data_ + size_, new_size - size_);
+            UninitializedDefaultConstructN(data_ + size_, new_size - size_);
+        }
+
+        size_ = new_size;
+    }
+
+    // Lets op write directly into storage for n elements without initializing it first, as with
+    // std::string::resize_and_overwrite. op(data, n) may construct elements in [Size(), n) and returns the new
+    // size m <= n. When it returns, elements [0, m) must be alive and only those: the vector destroys the old
+    // ones in [m, Size()), but op must itself destroy anything it built in [max(m, Size()), n). If op throws,
+    // the vector keeps its previous size, so op must likewise destroy what it built past Size().
+    template <typename Operation>
+    VECTOR_CONSTEXPR void ResizeForOverwrite(size_t n, Operation op) {
+        Reserve(n);
+
+        const size_t new_size = std::move(op)(data_.GetAddress(), n);
+        assert(new_size <= n);
+
+        if (new_size < size_) {
+            std::destroy_n(data_ + new_size, size_ - new_size);
         }
 
         size_ = new_size;
     }
 
     template <typename U>
-    void PushBack(U&& value) {
+    VECTOR_CONSTEXPR void PushBack(U&& value) {
         EmplaceBack(std::forward<U>(value));
     }
 
-    void PopBack() noexcept {
+    VECTOR_CONSTEXPR void PopBack() noexcept(!hardening::BOUNDS) {
+        Check(size_ > 0, "PopBack on an empty vector");
         assert(size_ > 0);
         --size_;
         std::destroy_at(data_ + size_);
+        MaybeShrink();
     }
 
     template <typename... Args>
-    T& EmplaceBack(Args&&... args) {
+    VECTOR_CONSTEXPR T& EmplaceBack(Args&&... args) {
         if (size_ == data_.Capacity()) {
-            size_t temp_size = (size_ == 0) ? 1 : size_ * 2;
-
-            RawMemory<T> new_data(temp_size);
-
-            new (new_data.GetAddress() + size_) T(std::forward<Args>(args)...);
-
-            MoveDataIfPossibleOrCopyInstead(data_.GetAddress(), Size(), new_data.GetAddress());
+            return *InsertWithRealloc(Data() + size_, std::forward<Args>(args)...);
+        }
 
-            std::destroy_n(data_.GetAddress(), size_);
-            data_.Swap(new_data);
+        ConstructAt(data_.GetAddress() + size_, std::forward<Args>(args)...);
+        ++size_;
 
-        } else {
-            new (data_.GetAddress() + size_) T(std::forward<Args>(args)...);
-        }
+        return data_[size_ - 1];
+    }
 
+    // Appends without checking the capacity, which must have been reserved
+    template <typename... Args>
+    VECTOR_CONSTEXPR T& UncheckedEmplaceBack(Args&&... args) {
+        assert(size_ < data_.Capacity());
+        ConstructAt(data_.GetAddress() + size_, std::forward<Args>(args)...);
         ++size_;
 
         return data_[size_ - 1];
     }
 
-    size_t Size() const noexcept { return size_; }
+    // Reserves room for `count` more elements and returns a cursor that appends them. The cursor keeps its
+    // position in a local pointer and commits the size once, when it is destroyed, so a producer loop does
+    // no capacity checks and no stores to this vector. Nothing else may use the vector while the cursor lives.
+    VECTOR_CONSTEXPR BackCursor ReserveBack(size_t count) {
+        Reserve(size_ + count);
+        return BackCursor(*this);
+    }
+
+    VECTOR_CONSTEXPR size_t Size() const noexcept { return size_; }
+
+    VECTOR_CONSTEXPR size_t Capacity() const noexcept { return data_.Capacity(); }
 
-    size_t Capacity() const noexcept { return data_.Capacity(); }
+    VECTOR_CONSTEXPR Alloc GetAllocator() const noexcept { return data_.GetAllocator(); }
 
-    void Swap(Vector& other) noexcept {
+    VECTOR_CONSTEXPR void Swap(Vector& other) noexcept {
         data_.Swap(other.data_);
         std::swap(size_, other.size_);
     }
 
-    iterator Insert(const_iterator pos, const T& value) { return Emplace(pos, value); }
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, const T& value) { return Emplace(pos, value); }
 
-    iterator Insert(const_iterator pos, T&& value) { return Emplace(pos, std::move(value)); }
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, T&& value) { return Emplace(pos, std::move(value)); }
 
-    template <typename InputIt, typename OutputIt>
-    void MoveDataIfPossibleOrCopyInstead(InputIt input_it, size_t n, OutputIt output_it) {
-        if constexpr (std::is_nothrow_move_constructible_v<T> || !std::is_copy_constructible_v<T>) {
-            std::uninitialized_move_n(input_it, n, output_it);
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, size_t count, const T& value) {
+        // value may refer to an element of this vector, which the insertion is about to move
+        const T copy(value);
+        auto construct = [&copy](size_t, size_t n, T* to) { UninitializedFillN(to, n, copy); };
+        auto assign = [&copy](size_t, size_t n, T* to) { std::fill_n(to, n, copy); };
+        return InsertN(ToPointer(pos) - Data(), count, construct, assign);
+    }
+
+    // The range must not refer to elements of this vector.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR iterator Insert(const_iterator pos, InputIt first, InputIt last) {
+        using Category = typename std::iterator_traits<InputIt>::iterator_category;
+
+        if constexpr (std::is_convertible_v<Category, std::forward_iterator_tag>) {
+            auto construct = [first](size_t offset, size_t n, T* to) {
+                UninitializedCopyN(std::next(first, offset), n, to);
+            };
+            auto assign = [first](size_t offset, size_t n, T* to) { std::copy_n(std::next(first, offset), n, to); };
+            return InsertN(ToPointer(pos) - Data(), std::distance(first, last), construct, assign);
         } else {
-            std::uninitialized_copy_n(input_it, n, output_it);
+            // Single-pass ranges are buffered so that the insertion still shifts the tail only once
+            Vector temp(data_.GetAllocator());
+            for (; first != last; ++first) {
+                temp.EmplaceBack(*first);
+            }
+            return Insert(pos, std::make_move_iterator(temp.begin()), std::make_move_iterator(temp.end()));
         }
     }
 
+    template <typename Range>
+    VECTOR_CONSTEXPR void Append(const Range& range) {
+        Insert(cend(), std::begin(range), std::end(range));
+    }
+
     template <typename... Args>
-    iterator InsertWithRealloc(iterator pos, Args&&... args) {
-        size_t dist = std::distance(begin(), pos);
+    VECTOR_CONSTEXPR iterator Emplace(const_iterator p, Args&&... args) {
+        T* pos = ToPointer(p);
+
+        if (size_ == Capacity()) {
+            return MakeIterator(InsertWithRealloc(pos, std::forward<Args>(args)...));
+        } else {
+            return MakeIterator(InsertWithoutRealloc(pos, std::forward<Args>(args)...));
+        }
+    }
 
-        size_t temp_size = (size_ == 0) ? 1 : size_ * 2;
-        RawMemory<T> new_data(temp_size);
+    VECTOR_CONSTEXPR iterator Erase(const_iterator p) {
+        T* pos = ToPointer(p);
 
-        try {
-            new (new_data.GetAddress() + dist) T(std::forward<Args>(args)...);
+        if (size_ == 0) {
+            return MakeIterator(pos);
+        }
 
-            MoveDataIfPossibleOrCopyInstead(data_.GetAddress(), dist, new_data.GetAddress());
-            MoveDataIfPossibleOrCopyInstead(data_.GetAddress() + dist, size_ - dist, new_data.GetAddress() + dist + 1);
+        Check(pos != data_ + size_, "Erase of end()");
+        const size_t dist = pos - data_.GetAddress();
 
-            std::destroy_n(data_.GetAddress(), size_);
-            data_.Swap(new_data);
-            ++size_;
+        std::move(pos + 1, data_ + size_, pos);
+
+        PopBack();
+
+        return begin() + dist;
+    }
+
+    VECTOR_CONSTEXPR iterator Erase(const_iterator first, const_iterator last) {
+        T* pos = ToPointer(first);
+        T* const end = data_ + size_;
+        Check(pos <= ToPointer(last), "Erase of a reversed range");
+        const size_t dist = pos - data_.GetAddress();
+        const size_t count = ToPointer(last) - pos;
+
+        if (count == 0) {
+            return MakeIterator(pos);
+        }
+
+        T* const tail = pos + count;
+        if (IsTriviallyRelocatable<T>::value && !IsConstantEvaluated()) {
+            std::destroy_n(pos, count);
+            // The comparison lets GCC bound the length, it can't tell that last <= end()
+            const size_t tail_size = tail < end ? end - tail : 0;
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(tail), tail_size * sizeof(T));
+        } else {
+            std::move(tail, end, pos);
+            std::destroy_n(end - count, count);
+        }
+
+        size_ -= count;
+        MaybeShrink();
+
+        return begin() + dist;
+    }
+
+    // Removes the element in O(1) by moving the last element into its place, so the order isn't preserved.
+    // Returns an iterator to the element that took the removed one's place.
+    VECTOR_CONSTEXPR iterator EraseUnordered(const_iterator p) {
+        T* pos = ToPointer(p);
+        Check(pos != data_ + size_, "EraseUnordered of end()");
+        const size_t dist = pos - data_.GetAddress();
+
+        if (dist + 1 != size_) {
+            *pos = std::move(data_[size_ - 1]);
+        }
+        PopBack();
+
+        return begin() + dist;
+    }
+
+    // Removes the elements at the given indices, each in O(1) as EraseUnordered does. Indices may come in
+    // any order and repeat, but each must be less than Size(), which only hardened builds check. Returns the
+    // number of removed elements.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR size_t EraseUnorderedIndices(InputIt first_index, InputIt last_index) {
+        const Vector<size_t> indices = SortedIndices(first_index, last_index);
+
+        // Going from the back, the last element is never one that is still to be removed
+        for (size_t k = indices.Size(); k-- > 0;) {
+            const size_t index = indices[k];
+            if (index + 1 != size_) {
+                data_[index] = std::move(data_[size_ - 1]);
+            }
+            --size_;
+            std::destroy_at(data_ + size_);
+        }
+        MaybeShrink();
+
+        return indices.Size();
+    }
+
+    // Removes the elements at the given indices, preserving the order of the rest. The survivors are
+    // compacted in a single pass, however many indices there are. Indices are taken as by
+    // EraseUnorderedIndices. Returns the number of removed elements.
+    template <typename InputIt, typename = RequireInputIterator<InputIt>>
+    VECTOR_CONSTEXPR size_t EraseIndices(InputIt first_index, InputIt last_index) {
+        const Vector<size_t> indices = SortedIndices(first_index, last_index);
+        if (indices.Size() == 0) {
+            return 0;
+        }
+
+        T* write = data_ + indices[0];
+        for (size_t k = 0; k < indices.Size(); ++k) {
+            const size_t next = k + 1 < indices.Size() ? indices[k + 1] : size_;
+            write = std::move(data_ + indices[k] + 1, data_ + next, write);
+        }
+
+        std::destroy(write, data_ + size_);
+        size_ = write - data_.GetAddress();
+        MaybeShrink();
+
+        return indices.Size();
+    }
+
+    // Removes elements satisfying pred in a single pass, preserving the order of the rest. Returns the number
+    // of removed elements.
+    template <typename Predicate>
+    VECTOR_CONSTEXPR size_t EraseIf(Predicate pred) {
+        T* new_end = std::remove_if(Data(), Data() + size_, pred);
+        const size_t count = Data() + size_ - new_end;
+
+        std::destroy_n(new_end, count);
+        size_ -= count;
+        MaybeShrink();
+
+        return count;
+    }
+
+    VECTOR_CONSTEXPR const T& operator[](size_t index) const noexcept(!hardening::BOUNDS) {
+        Check(index < size_, "index out of range");
+        return data_[index];
+    }
+
+    VECTOR_CONSTEXPR T& operator[](size_t index) noexcept(!hardening::BOUNDS) {
+        Check(index < size_, "index out of range");
+        return data_[index];
+    }
+
+    // Vectorized scans for arithmetic T, see vector_simd.h
+    const_iterator Find(T value) const noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        return begin() + simd::Find(Data(), size_, value);
+    }
+
+    iterator Find(T value) noexcept { return begin() + (std::as_const(*this).Find(value) - cbegin()); }
+
+    size_t Count(T value) const noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        return simd::Count(Data(), size_, value);
+    }
+
+    // Assigns value to every element
+    void Fill(T value) noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        simd::Fill(Data(), size_, value);
+    }
+
+    T Sum() const noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        return simd::Sum(Data(), size_);
+    }
+
+    // The vector must not be empty
+    T Min() const noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        assert(size_ > 0);
+        return simd::Min(Data(), size_);
+    }
+
+    T Max() const noexcept {
+        static_assert(simd::IS_SUPPORTED<T>, "vectorized scans need arithmetic elements");
+        assert(size_ > 0);
+        return simd::Max(Data(), size_);
+    }
+
+private:
+    VECTOR_CONSTEXPR iterator MakeIterator(T* p) noexcept {
+        if constexpr (hardening::ITERATORS) {
+            return iterator(p, IsSampled() ? this : nullptr);
+        } else {
+            return p;
+        }
+    }
+
+    VECTOR_CONSTEXPR const_iterator MakeIterator(const T* p) const noexcept {
+        if constexpr (hardening::ITERATORS) {
+            return const_iterator(p, IsSampled() ? this : nullptr);
+        } else {
+            return p;
+        }
+    }
+
+    // Element pointer of an iterator passed in by the caller, checked to be valid for this vector and to
+    // point into [begin(), end()]
+    VECTOR_CONSTEXPR T* ToPointer(const_iterator pos) const {
+        const T* p = nullptr;
+        if constexpr (hardening::ITERATORS) {
+            Check(pos.IsValid(), "iterator invalidated by reallocation");
+            p = pos.Base();
+        } else {
+            p = pos;
+        }
+        Check(Data() <= p && p <= Data() + size_, "iterator out of range");
+        return const_cast<T*>(p);
+    }
+
+    VECTOR_CONSTEXPR void Check(bool ok, const char* what) const {
+        if constexpr (hardening::BOUNDS) {
+            if (IsSampled() && !ok) [[unlikely]] {
+                hardening::Fail(what);
+            }
+        }
+    }
+
+    VECTOR_CONSTEXPR bool Contains(const T* p) const noexcept {
+        return std::less_equal<const T*>{}(Data(), p) && std::less<const T*>{}(p, Data() + size_);
+    }
+
+    // Inserts n elements at index dist, reallocating at most once and shifting the tail once. construct(offset,
+    // count, to) builds inserted elements [offset, offset + count) in uninitialized memory and assign(offset,
+    // count, to) assigns them over live elements. Gives the strong guarantee when reallocation happens or T
+    // is trivially relocatable.
+    template <typename Construct, typename Assign>
+    VECTOR_CONSTEXPR iterator InsertN(size_t dist, size_t n, Construct construct, Assign assign) {
+        if (n == 0) {
+            return begin() + dist;
+        }
+
+        if (size_ + n > Capacity()) {
+            const size_t new_capacity = std::max(GrownCapacity(), size_ + n);
+
+            if constexpr (GROWS_IN_PLACE) {
+                data_.Reallocate(new_capacity);
+                NextGeneration();
+                InsertRelocatable(dist, n, construct);
+            } else {
+                RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
+
+                construct(0, n, new_data + dist);
+
+                try {
+                    RelocateWithGap(data_.GetAddress(), size_, dist, new_data.GetAddress(), n);
+                } catch (...) {
+                    std::destroy_n(new_data + dist, n);
+                    throw;
+                }
+
+                data_.Swap(new_data);
+                NextGeneration();
+                size_ += n;
+            }
+        } else if (IsTriviallyRelocatable<T>::value && !IsConstantEvaluated()) {
+            InsertRelocatable(dist, n, construct);
+        } else {
+            T* pos = data_ + dist;
+            T* old_end = data_ + size_;
+            const size_t elems_after = size_ - dist;
+
+            if (elems_after > n) {
+                UninitializedMoveN(old_end - n, n, old_end);
+                size_ += n;
+                std::move_backward(pos, old_end - n, old_end);
+                assign(0, n, pos);
+            } else {
+                construct(elems_after, n - elems_after, old_end);
+                size_ += n - elems_after;
+                UninitializedMoveN(pos, elems_after, pos + n);
+                size_ += elems_after;
+                assign(0, elems_after, pos);
+            }
+        }
+
+        return begin() + dist;
+    }
+
+    // Opens the gap with memmove, so it only runs outside constant evaluation
+    template <typename Construct>
+    void InsertRelocatable(size_t dist, size_t n, Construct construct) {
+        T* pos = data_ + dist;
+        const size_t tail_bytes = (size_ - dist) * sizeof(T);
+
+        std::memmove(static_cast<void*>(pos + n), static_cast<const void*>(pos), tail_bytes);
+        try {
+            construct(0, n, pos);
         } catch (...) {
-            std::destroy_at(std::addressof(new_data));
+            std::memmove(static_cast<void*>(pos), static_cast<const void*>(pos + n), tail_bytes);
+            throw;
         }
 
-        return &data_[dist];
+        size_ += n;
     }
 
     template <typename... Args>
-    iterator InsertWithoutRealloc(iterator pos, Args&&... args) {
-        size_t dist = std::distance(begin(), pos);
+    VECTOR_COLD VECTOR_CONSTEXPR T* InsertWithRealloc(T* pos, Args&&... args) {
+        size_t dist = pos - data_.GetAddress();
 
-        iterator it = &data_[dist];
+        size_t temp_size = GrownCapacity();
 
-        if (pos == nullptr || pos == end()) {
-            new (end()) T(std::forward<Args>(args)...);
-        } else {
-            new (end()) T(std::forward<T>(*(end() - 1)));
-            std::move_backward(it, end() - 1, end());
-            *it = T(std::forward<Args>(args)...);
+        if constexpr (GROWS_IN_PLACE) {
+            GrowInPlace(temp_size, dist, std::forward<Args>(args)...);
+            ++size_;
+            return data_ + dist;
+        }
+
+        RawMemory<T, Alloc> new_data(temp_size, data_.GetAllocator());
+
+        ConstructAt(new_data.GetAddress() + dist, std::forward<Args>(args)...);
+
+        try {
+            RelocateWithGap(data_.GetAddress(), size_, dist, new_data.GetAddress());
+        } catch (...) {
+            std::destroy_at(new_data.GetAddress() + dist);
+            throw;
         }
 
+        data_.Swap(new_data);
+        NextGeneration();
         ++size_;
 
-        return it;
+        return data_ + dist;
     }
 
     template <typename... Args>
-    iterator Emplace(const_iterator p, Args&&... args) {
-        iterator pos = const_cast<iterator>(p);
+    VECTOR_CONSTEXPR T* InsertWithoutRealloc(T* pos, Args&&... args) {
+        T* it = pos;
+        T* last = data_ + size_;
 
-        if (size_ == Capacity()) {
-            return InsertWithRealloc(pos, std::forward<Args>(args)...);
-        } else {
-            return InsertWithoutRealloc(pos, std::forward<Args>(args)...);
+        if (it == last) {
+            ConstructAt(last, std::forward<Args>(args)...);
+            ++size_;
+            return it;
+        }
+
+        if constexpr (IsTriviallyRelocatable<T>::value) {
+            if (!IsConstantEvaluated()) {
+                // The value is built before the tail moves because args may refer to elements of this vector.
+                // Opening the hole and filling it are then plain byte copies.
+                alignas(T) unsigned char slot[sizeof(T)];
+                T* value = new (slot) T(std::forward<Args>(args)...);
+                std::memmove(static_cast<void*>(it + 1), static_cast<const void*>(it), (last - it) * sizeof(T));
+                RelocateBytes(value, 1, it);
+                ++size_;
+                return it;
+            }
+        }
+
+        if constexpr (sizeof...(Args) == 1 && (std::is_same_v<std::decay_t<Args>, T> && ...)) {
+            // Inserting a T assigns it straight into the hole unless it's one of the elements being shifted.
+            // Pointers into different objects can't be compared in constant evaluation, so it copies there.
+            if (!IsConstantEvaluated() && !(Contains(std::addressof(args)) || ...)) {
+                ShiftTailRight(it);
+                ((*it = std::forward<Args>(args)), ...);
+                return it;
+            }
         }
+
+        T temp(std::forward<Args>(args)...);
+        ShiftTailRight(it);
+        *it = std::move(temp);
+
+        return it;
+    }
+
+    // Moves elements [pos, end()) one slot to the right, growing the size by one. The element at pos is
+    // left moved-from.
+    VECTOR_CONSTEXPR void ShiftTailRight(T* pos) {
+        T* last = data_ + size_;
+        ConstructAt(last, std::move(*(last - 1)));
+        ++size_;
+        std::move_backward(pos, last - 1, last);
     }
 
-    iterator Erase(const_iterator p) {
-        iterator pos = const_cast<iterator>(p);
+    // The first allocation made by growing takes the capacity learned at the construction site at once
+    VECTOR_CONSTEXPR size_t GrownCapacity() const noexcept {
+        const size_t capacity = Growth::NextCapacity(size_);
+        return data_.Capacity() == 0 ? std::max(capacity, Hint()) : capacity;
+    }
 
-        if (begin() == end()) {
-            return pos;
+    VECTOR_CONSTEXPR void ChangeCapacity(size_t new_capacity) {
+        if constexpr (GROWS_IN_PLACE) {
+            if (new_capacity != 0) {
+                data_.Reallocate(new_capacity);
+                NextGeneration();
+                return;
+            }
         }
 
-        std::move(pos + 1, end(), pos);
+        RawMemory<T, Alloc> new_data(new_capacity, data_.GetAllocator());
 
-        PopBack();
+        RelocateN(data_.GetAddress(), size_, new_data.GetAddress());
 
-        return pos;
+        data_.Swap(new_data);
+        NextGeneration();
     }
 
-    const T& operator[](size_t index) const noexcept { return data_[index]; }
+    template <typename InputIt>
+    VECTOR_CONSTEXPR Vector<size_t> SortedIndices(InputIt first, InputIt last) const {
+        Vector<size_t> indices;
+        for (; first != last; ++first) {
+            indices.PushBack(*first);
+        }
+        std::sort(indices.begin(), indices.end());
+        indices.Erase(std::unique(indices.begin(), indices.end()), indices.end());
+        const bool in_range = indices.Size() == 0 || indices[indices.Size() - 1] < size_;
+        Check(in_range, "Erase of an index out of range");
+        assert(in_range);
+        return indices;
+    }
 
-    T& operator[](size_t index) noexcept { return data_[index]; }
+    VECTOR_CONSTEXPR void MaybeShrink() noexcept {
+        if constexpr (HasShrinkCapacity<Growth>::value) {
+            const size_t new_capacity = Growth::ShrinkCapacity(size_, data_.Capacity());
+            if (new_capacity < data_.Capacity()) {
+                try {
+                    ChangeCapacity(new_capacity);
+                } catch (...) {
+                    // Shrinking is best effort, so the vector keeps its buffer if reallocation fails
+                }
+            }
+        }
+    }
 
-private:
-    static void DestroyN(T* buf, size_t n) noexcept {
+    // Reallocates the buffer and relocates a new element into position `index`, shifting the tail. The
+    // element is built before the buffer moves because args may refer to elements of this vector.
+    template <typename... Args>
+    void GrowInPlace(size_t new_capacity, size_t index, Args&&... args) {
+        alignas(T) unsigned char slot[sizeof(T)];
+        T* value = new (slot) T(std::forward<Args>(args)...);
+
+        try {
+            data_.Reallocate(new_capacity);
+        } catch (...) {
+            std::destroy_at(value);
+            throw;
+        }
+        NextGeneration();
+
+        if (index != size_) {
+            std::memmove(static_cast<void*>(data_ + index + 1), static_cast<const void*>(data_ + index),
+                         (size_ - index) * sizeof(T));
+        }
+        RelocateBytes(value, 1, data_ + index);
+    }
+
+    VECTOR_CONSTEXPR static void DestroyN(T* buf, size_t n) noexcept {
         std::destroy_n(buf, n);
     }
 
-    static void CopyConstruct(T* buf, const T& elem) { new (buf) T(elem); }
+    VECTOR_CONSTEXPR static void CopyConstruct(T* buf, const T& elem) { ConstructAt(buf, elem); }
 
-    static void Destroy(T* buf) noexcept { std::destroy_at(buf); }
+    VECTOR_CONSTEXPR static void Destroy(T* buf) noexcept { std::destroy_at(buf); }
 
 private:
-    RawMemory<T> data_;
+    RawMemory<T, Alloc> data_;
     size_t size_ = 0;
 };
+
+namespace pmr {
+
+template <typename T, typename Growth = DoublingGrowth>
+using Vector = ::Vector<T, std::pmr::polymorphic_allocator<T>, Growth>;
+
+}  // namespace pmr
+
+// With the default allocator a Vector is just a buffer, a capacity and a size
+#ifndef VECTOR_ENABLE_CAPACITY_HINTS
+static_assert(hardening::BOUNDS || sizeof(Vector<int>) == 3 * sizeof(void*));
+#endif
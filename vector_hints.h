@@ -0,0 +1,268 @@
+#pragma once
+#include <cstddef>
+
+// Capacity learned per construction call site, compiled in only when VECTOR_ENABLE_CAPACITY_HINTS is defined
+// (consistently across translation units; it needs C++20 for std::source_location). Vector constructors take
+// the location they are called from, and a destroyed vector records the size it reached there. The first
+// growth of a later vector from the same site allocates the 90th percentile of those sizes at once instead of
+// going through 1, 2, 4, ... The learned capacities can be written out with Dump and read back at startup with
+// Load, so a new process starts with the hints of the previous one.
+#ifdef VECTOR_ENABLE_CAPACITY_HINTS
+
+#if __cplusplus < 202002L
+#error "VECTOR_ENABLE_CAPACITY_HINTS needs C++20"
+#endif
+
+#include <atomic>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <source_location>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+#define VECTOR_CURRENT_CALL_SITE std::source_location::current()
+
+namespace capacity_hints {
+
+using CallSite = std::source_location;
+
+// Sites beyond this are not tracked
+inline constexpr size_t MAX_SITES = 4096;
+inline constexpr double PERCENTILE = 0.9;
+// Until a site has recorded this many sizes, they only replace a hint of its own if none was loaded
+inline constexpr size_t LEARN_PERIOD = 16;
+
+// Bucket 0 counts empty vectors and bucket b > 0 the sizes in (2^(b-2), 2^(b-1)]
+inline constexpr size_t BUCKETS = 66;
+
+inline size_t BucketOf(size_t size) noexcept {
+    return size <= 1 ? size : static_cast<size_t>(65 - __builtin_clzll(size - 1));
+}
+
+class Site {
+public:
+    size_t Hint() const noexcept { return hint_.load(std::memory_order_relaxed); }
+
+    void Record(size_t size) noexcept {
+        buckets_[BucketOf(size)].fetch_add(1, std::memory_order_relaxed);
+        const size_t samples = samples_.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (samples % LEARN_PERIOD == 0 || (samples < LEARN_PERIOD && !loaded_.load(std::memory_order_relaxed))) {
+            Learn(samples);
+        }
+    }
+
+    void SetHint(size_t hint) noexcept { hint_.store(hint, std::memory_order_relaxed); }
+
+    void LoadHint(size_t hint) noexcept {
+        loaded_.store(true, std::memory_order_relaxed);
+        SetHint(hint);
+    }
+
+    void Reset() noexcept {
+        for (std::atomic<size_t>& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        samples_.store(0, std::memory_order_relaxed);
+        hint_.store(0, std::memory_order_relaxed);
+        loaded_.store(false, std::memory_order_relaxed);
+    }
+
+    // Set once before the site is published
+    CallSite location;
+    std::atomic<bool> ready{false};
+
+private:
+    // Concurrent recorders may count a few samples twice or not at all; the result is approximate anyway
+    void Learn(size_t samples) noexcept {
+        const size_t rank = static_cast<size_t>(PERCENTILE * static_cast<double>(samples - 1)) + 1;
+        size_t seen = 0;
+        for (size_t b = 0; b < BUCKETS; ++b) {
+            seen += buckets_[b].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                SetHint(b == 0 ? 0 : size_t{1} << (b - 1));
+                return;
+            }
+        }
+    }
+
+    std::atomic<size_t> buckets_[BUCKETS] = {};
+    std::atomic<size_t> samples_{0};
+    std::atomic<size_t> hint_{0};
+    std::atomic<bool> loaded_{false};
+};
+
+// Open-addressing table of sites. Lookups of registered sites are lock-free; registering a new one takes
+// the mutex. Nothing in it needs destruction, so vectors destroyed during static destruction can still record.
+struct Registry {
+    Site sites[MAX_SITES];
+    std::mutex mutex;
+    // Hints loaded for sites that haven't been constructed from yet, keyed by Key()
+    std::unordered_map<std::string, size_t>* loaded = new std::unordered_map<std::string, size_t>();
+};
+
+inline Registry& GetRegistry() noexcept {
+    static Registry* registry = new Registry();
+    return *registry;
+}
+
+inline bool SameSite(const CallSite& lhs, const CallSite& rhs) noexcept {
+    return lhs.line() == rhs.line() && lhs.column() == rhs.column() && lhs.file_name() == rhs.file_name()
+           && lhs.function_name() == rhs.function_name();
+}
+
+inline size_t HashOf(const CallSite& site) noexcept {
+    size_t hash = reinterpret_cast<size_t>(site.file_name()) ^ reinterpret_cast<size_t>(site.function_name());
+    hash = hash * 31 + site.line();
+    hash = hash * 31 + site.column();
+    return hash * 0x9e3779b97f4a7c15 >> 20;
+}
+
+// Identifies a site across processes
+inline std::string Key(const CallSite& site) {
+    return std::string(site.file_name()) + '\t' + std::to_string(site.line()) + '\t' + std::to_string(site.column())
+           + '\t' + site.function_name();
+}
+
+// Returns nullptr when the table is full
+inline Site* Find(const CallSite& location) noexcept {
+    Registry& registry = GetRegistry();
+    const size_t start = HashOf(location);
+
+    for (size_t probe = 0; probe < MAX_SITES; ++probe) {
+        Site& site = registry.sites[(start + probe) % MAX_SITES];
+        if (!site.ready.load(std::memory_order_acquire)) {
+            break;
+        }
+        if (SameSite(site.location, location)) {
+            return &site;
+        }
+    }
+
+    try {
+        std::lock_guard lock(registry.mutex);
+        for (size_t probe = 0; probe < MAX_SITES; ++probe) {
+            Site& site = registry.sites[(start + probe) % MAX_SITES];
+            if (!site.ready.load(std::memory_order_relaxed)) {
+                site.location = location;
+                if (auto it = registry.loaded->find(Key(location)); it != registry.loaded->end()) {
+                    site.LoadHint(it->second);
+                }
+                site.ready.store(true, std::memory_order_release);
+                return &site;
+            }
+            if (SameSite(site.location, location)) {
+                return &site;
+            }
+        }
+    } catch (...) {
+        // Without memory for the key the site just goes untracked
+    }
+    return nullptr;
+}
+
+// Writes one line per site that has a hint: file, line, column, function and capacity, separated by tabs
+inline void Dump(std::ostream& out) {
+    Registry& registry = GetRegistry();
+    for (const Site& site : registry.sites) {
+        if (site.ready.load(std::memory_order_acquire) && site.Hint() != 0) {
+            out << Key(site.location) << '\t' << site.Hint() << '\n';
+        }
+    }
+}
+
+// Reads lines written by Dump. Hints apply to sites already in use and to ones constructed from later, and
+// give way to what a site learns once it has recorded LEARN_PERIOD sizes.
+inline void Load(std::istream& in) {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t separator = line.rfind('\t');
+        if (separator == std::string::npos) {
+            continue;
+        }
+        (*registry.loaded)[line.substr(0, separator)] = std::stoull(line.substr(separator + 1));
+    }
+
+    for (Site& site : registry.sites) {
+        if (site.ready.load(std::memory_order_relaxed)) {
+            if (auto it = registry.loaded->find(Key(site.location)); it != registry.loaded->end()) {
+                site.LoadHint(it->second);
+            }
+        }
+    }
+}
+
+// Forgets everything learned and loaded
+inline void Reset() {
+    Registry& registry = GetRegistry();
+    std::lock_guard lock(registry.mutex);
+    registry.loaded->clear();
+    for (Site& site : registry.sites) {
+        site.Reset();
+    }
+}
+
+// Vector derives from it to remember its construction site
+class Tracker {
+public:
+    constexpr Tracker() noexcept = default;
+
+    constexpr explicit Tracker(const CallSite& location) noexcept {
+        if (!std::is_constant_evaluated()) {
+            site_ = Find(location);
+        }
+    }
+
+    // A copy is expected to grow like the vector it copies
+    constexpr Tracker(const Tracker& other) noexcept = default;
+
+    // The moved-from vector doesn't record, its elements went elsewhere
+    constexpr Tracker(Tracker&& other) noexcept : site_(std::exchange(other.site_, nullptr)) {}
+
+    constexpr Tracker& operator=(const Tracker&) noexcept { return *this; }
+
+    constexpr size_t Hint() const noexcept { return site_ != nullptr ? site_->Hint() : 0; }
+
+    constexpr void Record(size_t size) noexcept {
+        if (site_ != nullptr) {
+            site_->Record(size);
+        }
+    }
+
+    constexpr void StopRecording() noexcept { site_ = nullptr; }
+
+private:
+    Site* site_ = nullptr;
+};
+
+}  // namespace capacity_hints
+
+#else
+
+#define VECTOR_CURRENT_CALL_SITE capacity_hints::CallSite{}
+
+namespace capacity_hints {
+
+struct CallSite {};
+
+class Tracker {
+public:
+    constexpr Tracker() noexcept = default;
+
+    constexpr explicit Tracker(CallSite) noexcept {}
+
+    constexpr size_t Hint() const noexcept { return 0; }
+
+    constexpr void Record(size_t) noexcept {}
+
+    constexpr void StopRecording() noexcept {}
+};
+
+}  // namespace capacity_hints
+
+#endif
@@ -0,0 +1,264 @@
+#pragma once
+#include "vector.h"
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Binary I/O of Vectors of trivially copyable elements. The buffer is written as is after a small header,
+// and reading goes straight into the vector's storage without constructing elements one by one. The format
+// uses the native byte order, so it's meant for checkpoints read back on the same kind of machine.
+struct VectorIOHeader {
+    static constexpr uint64_t MAGIC = 0x4f49524f54434556;  // "VECTORIO"
+
+    uint64_t magic = MAGIC;
+    uint32_t element_size = 0;
+    uint32_t element_alignment = 0;
+    uint64_t size = 0;
+};
+
+namespace vector_io_detail {
+
+template <typename T>
+VectorIOHeader MakeHeader(size_t size) {
+    static_assert(std::is_trivially_copyable_v<T>, "only trivially copyable elements can be written as bytes");
+    VectorIOHeader header;
+    header.element_size = sizeof(T);
+    header.element_alignment = alignof(T);
+    header.size = size;
+    return header;
+}
+
+template <typename T>
+void CheckHeader(const VectorIOHeader& header) {
+    if (header.magic != VectorIOHeader::MAGIC) {
+        throw std::runtime_error("not a serialized vector");
+    }
+    if (header.element_size != sizeof(T) || header.element_alignment != alignof(T)) {
+        throw std::runtime_error("serialized vector holds elements of a different type");
+    }
+}
+
+[[noreturn]] inline void ThrowSystemError(const char* what) {
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+// Fails fast on a header that promises more elements than the rest of a regular file holds, before any memory
+// is reserved for them. Pipes and other descriptors without a known length are taken on trust.
+template <typename T>
+void CheckRemaining(int fd, const VectorIOHeader& header) {
+    struct stat st {};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return;
+    }
+    const off_t position = lseek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        return;
+    }
+    const uint64_t remaining = st.st_size > position ? static_cast<uint64_t>(st.st_size - position) : 0;
+    if (header.size > remaining / sizeof(T)) {
+        throw std::runtime_error("serialized vector is longer than the file");
+    }
+}
+
+// Writes all iovecs, resuming after partial writes and interrupted calls
+inline void WriteAll(int fd, iovec* iov, int count) {
+    while (count > 0) {
+        const ssize_t written = writev(fd, iov, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("writev");
+        }
+
+        size_t remaining = static_cast<size_t>(written);
+        while (count > 0 && remaining >= iov->iov_len) {
+            remaining -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0) {
+            iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+            iov->iov_len -= remaining;
+        }
+    }
+}
+
+inline void ReadAll(int fd, void* buffer, size_t length) {
+    char* out = static_cast<char*>(buffer);
+    while (length > 0) {
+        const ssize_t bytes = read(fd, out, length);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            ThrowSystemError("read");
+        }
+        if (bytes == 0) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+        out += bytes;
+        length -= bytes;
+    }
+}
+
+inline constexpr size_t STREAM_CHUNK_BYTES = size_t{1} << 20;
+
+// Reads n elements into data on a background thread, chunk by chunk, and tells the consumer how many are
+// complete. The destructor asks the thread to stop after its current chunk and joins it.
+template <typename T>
+class ReadAhead {
+public:
+    ReadAhead(int fd, T* data, size_t n, size_t chunk)
+        : thread_([this, fd, data, n, chunk] { Run(fd, data, n, chunk); }) {}
+
+    ReadAhead(const ReadAhead&) = delete;
+
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    ~ReadAhead() {
+        cancelled_.store(true, std::memory_order_relaxed);
+        thread_.join();
+    }
+
+    // Blocks until more than `consumed` elements are read and returns how many there are. Rethrows the error
+    // of the reading thread.
+    size_t WaitPast(size_t consumed) {
+        std::unique_lock lock(mutex_);
+        ready_.wait(lock, [&] { return loaded_ > consumed || error_ != nullptr; });
+        if (error_ != nullptr) {
+            std::rethrow_exception(error_);
+        }
+        return loaded_;
+    }
+
+private:
+    void Run(int fd, T* data, size_t n, size_t chunk) noexcept {
+        try {
+            for (size_t done = 0; done < n && !cancelled_.load(std::memory_order_relaxed);) {
+                const size_t count = std::min(chunk, n - done);
+                ReadAll(fd, data + done, count * sizeof(T));
+                done += count;
+                Publish(done, nullptr);
+            }
+        } catch (...) {
+            Publish(0, std::current_exception());
+        }
+    }
+
+    void Publish(size_t loaded, std::exception_ptr error) noexcept {
+        {
+            std::lock_guard lock(mutex_);
+            loaded_ = std::max(loaded_, loaded);
+            error_ = error;
+        }
+        ready_.notify_one();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    size_t loaded_ = 0;
+    std::exception_ptr error_;
+    std::atomic<bool> cancelled_{false};
+    // Started last, once the state it uses is initialized
+    std::thread thread_;
+};
+
+}  // namespace vector_io_detail
+
+template <typename T, typename Alloc, typename Growth>
+void WriteTo(int fd, const Vector<T, Alloc, Growth>& v) {
+    VectorIOHeader header = vector_io_detail::MakeHeader<T>(v.Size());
+    iovec iov[] = {{&header, sizeof(header)}, {const_cast<T*>(v.Data()), v.Size() * sizeof(T)}};
+    vector_io_detail::WriteAll(fd, iov, 2);
+}
+
+// Replaces the contents of v. On failure v is left empty.
+template <typename T, typename Alloc, typename Growth>
+void ReadFrom(int fd, Vector<T, Alloc, Growth>& v) {
+    v.Clear();
+    VectorIOHeader header;
+    vector_io_detail::ReadAll(fd, &header, sizeof(header));
+    vector_io_detail::CheckHeader<T>(header);
+    vector_io_detail::CheckRemaining<T>(fd, header);
+
+    v.ResizeForOverwrite(header.size, [fd](T* data, size_t n) {
+        vector_io_detail::ReadAll(fd, data, n * sizeof(T));
+        return n;
+    });
+}
+
+// Same as ReadFrom(fd, v), but the elements are read in chunks of about chunk_bytes by a background thread
+// straight into v's storage, and on_chunk(T* data, size_t n) runs on the calling thread for every chunk
+// already read, in order. Processing a chunk thus overlaps with reading the ones after it. On failure,
+// including an exception thrown by on_chunk, v is left empty.
+template <typename T, typename Alloc, typename Growth, typename OnChunk>
+void StreamFrom(int fd, Vector<T, Alloc, Growth>& v, OnChunk on_chunk,
+                size_t chunk_bytes = vector_io_detail::STREAM_CHUNK_BYTES) {
+    v.Clear();
+    VectorIOHeader header;
+    vector_io_detail::ReadAll(fd, &header, sizeof(header));
+    vector_io_detail::CheckHeader<T>(header);
+    vector_io_detail::CheckRemaining<T>(fd, header);
+
+    // Only a hint, which fails harmlessly for pipes
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    const size_t chunk = std::max(chunk_bytes / sizeof(T), size_t{1});
+    v.ResizeForOverwrite(header.size, [fd, chunk, &on_chunk](T* data, size_t n) {
+        vector_io_detail::ReadAhead<T> reader(fd, data, n, chunk);
+        size_t consumed = 0;
+        while (consumed < n) {
+            const size_t loaded = reader.WaitPast(consumed);
+            while (consumed < loaded) {
+                const size_t count = std::min(chunk, loaded - consumed);
+                on_chunk(data + consumed, count);
+                consumed += count;
+            }
+        }
+        return n;
+    });
+}
+
+template <typename T, typename Alloc, typename Growth>
+void WriteTo(std::ostream& out, const Vector<T, Alloc, Growth>& v) {
+    const VectorIOHeader header = vector_io_detail::MakeHeader<T>(v.Size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(v.Data()), v.Size() * sizeof(T));
+    if (!out) {
+        throw std::runtime_error("failed to write serialized vector");
+    }
+}
+
+// Replaces the contents of v. On failure v is left empty.
+template <typename T, typename Alloc, typename Growth>
+void ReadFrom(std::istream& in, Vector<T, Alloc, Growth>& v) {
+    v.Clear();
+    VectorIOHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("unexpected end of serialized vector");
+    }
+    vector_io_detail::CheckHeader<T>(header);
+
+    v.ResizeForOverwrite(header.size, [&in](T* data, size_t n) {
+        if (!in.read(reinterpret_cast<char*>(data), n * sizeof(T))) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+        return n;
+    });
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include "vector.h"
+
+#include <exception>
+#include <thread>
+
+// Multi-threaded construction of large Vectors. The new range is split into one contiguous chunk per
+// thread and every worker constructs its own chunk, so with first-touch page placement each chunk's pages
+// land on the NUMA node of the thread that wrote them. Ranges below MIN_ELEMENTS_PER_THREAD per thread
+// aren't worth spawning threads for and are constructed on the calling thread.
+namespace parallel {
+
+inline constexpr size_t MIN_ELEMENTS_PER_THREAD = size_t{1} << 15;
+
+inline size_t DefaultThreadCount() noexcept { return std::max(1u, std::thread::hardware_concurrency()); }
+
+// Calls construct(from, to) for consecutive chunks of [0, n) on up to `threads` threads. If any call throws,
+// the chunks that were built completely are destroyed and the first exception is rethrown; construct must
+// itself clean up a chunk it fails to build, as the std::uninitialized_* algorithms do.
+template <typename T, typename Construct>
+void ConstructChunks(T* data, size_t n, size_t threads, Construct construct) {
+    threads = std::clamp<size_t>(n / MIN_ELEMENTS_PER_THREAD, 1, std::max<size_t>(threads, 1));
+    if (threads == 1) {
+        construct(size_t{0}, n);
+        return;
+    }
+
+    const size_t chunk = (n + threads - 1) / threads;
+    const auto chunk_begin = [&](size_t i) { return std::min(n, i * chunk); };
+
+    Vector<std::exception_ptr> errors(threads);
+    Vector<std::thread> workers;
+    workers.Reserve(threads - 1);
+
+    const auto run = [&](size_t i) {
+        try {
+            construct(chunk_begin(i), chunk_begin(i + 1));
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    for (size_t i = 1; i < threads; ++i) {
+        try {
+            workers.EmplaceBack(run, i);
+        } catch (...) {
+            // Couldn't start a thread: its chunk is built on this one instead
+            run(i);
+        }
+    }
+    run(0);
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    const auto first_error = std::find_if(errors.begin(), errors.end(), [](const auto& e) { return e != nullptr; });
+    if (first_error == errors.end()) {
+        return;
+    }
+
+    for (size_t i = 0; i < threads; ++i) {
+        if (!errors[i]) {
+            std::destroy(data + chunk_begin(i), data + chunk_begin(i + 1));
+        }
+    }
+    std::rethrow_exception(*first_error);
+}
+
+// Value-initializes new elements like Vector(size_t), or destroys the excess ones when shrinking
+template <typename T, typename Alloc, typename Growth>
+void Resize(Vector<T, Alloc, Growth>& v, size_t new_size, size_t threads = DefaultThreadCount()) {
+    if (new_size <= v.Size()) {
+        v.Resize(new_size);
+        return;
+    }
+
+    const size_t old_size = v.Size();
+    v.ResizeForOverwrite(new_size, [&](T* data, size_t n) {
+        T* tail = data + old_size;
+        ConstructChunks(tail, n - old_size, threads, [tail](size_t from, size_t to) {
+            std::uninitialized_value_construct(tail + from, tail + to);
+        });
+        return n;
+    });
+}
+
+// Replaces the contents of v with count copies of value, reusing v's storage when it's large enough. The old
+// elements are destroyed before the new ones are built, so if a chunk throws, v is left empty.
+template <typename T, typename Alloc, typename Growth>
+void Fill(Vector<T, Alloc, Growth>& v, size_t count, const T& value, size_t threads = DefaultThreadCount()) {
+    const T copy(value);
+    v.Clear();
+    v.ResizeForOverwrite(count, [&](T* data, size_t n) {
+        ConstructChunks(data, n, threads, [data, &copy](size_t from, size_t to) {
+            std::uninitialized_fill(data + from, data + to, copy);
+        });
+        return n;
+    });
+}
+
+// Replaces the contents of dst with copies of the elements of src, reusing dst's storage when it's large
+// enough. As with Fill, dst is left empty if a chunk throws.
+template <typename T, typename Alloc, typename Growth>
+void Assign(Vector<T, Alloc, Growth>& dst, const Vector<T, Alloc, Growth>& src,
+            size_t threads = DefaultThreadCount()) {
+    if (&dst == &src) {
+        return;
+    }
+
+    const T* source = src.begin();
+    dst.Clear();
+    dst.ResizeForOverwrite(src.Size(), [&](T* data, size_t n) {
+        ConstructChunks(data, n, threads, [data, source](size_t from, size_t to) {
+            std::uninitialized_copy(source + from, source + to, data + from);
+        });
+        return n;
+    });
+}
+
+template <typename T, typename Alloc, typename Growth>
+Vector<T, Alloc, Growth> Copy(const Vector<T, Alloc, Growth>& src, size_t threads = DefaultThreadCount()) {
+    Vector<T, Alloc, Growth> result(
+        std::allocator_traits<Alloc>::select_on_container_copy_construction(src.GetAllocator()));
+    Assign(result, src, threads);
+    return result;
+}
+
+}  // namespace parallel
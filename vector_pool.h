@@ -0,0 +1,123 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Thread-local cache of freed RawMemory buffers, compiled in only when VECTOR_ENABLE_POOL is defined
+// (consistently across translation units). Buffers of std::allocator are grouped by byte size into
+// power-of-two classes; a freed buffer is kept on its class's free list and handed to the next allocation of
+// the same class on that thread, whatever its element type. Each thread caches at most BLOCKS_PER_CLASS
+// buffers per class and nothing larger than MAX_CLASS_BYTES, and frees its cache when it exits.
+namespace vector_pool {
+
+inline constexpr size_t MIN_CLASS_BYTES = 16;
+inline constexpr size_t MAX_CLASS_BYTES = size_t{64} << 10;
+inline constexpr size_t CLASSES = 13;
+inline constexpr size_t BLOCKS_PER_CLASS = 8;
+
+static_assert(MIN_CLASS_BYTES << (CLASSES - 1) == MAX_CLASS_BYTES);
+
+// Only buffers of the default allocator are interchangeable, and only when operator new aligns them
+template <typename T, typename Alloc>
+inline constexpr bool IS_POOLED =
+#ifdef VECTOR_ENABLE_POOL
+    std::is_same_v<Alloc, std::allocator<T>> && alignof(T) <= __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+#else
+    false;
+#endif
+
+struct Stats {
+    // Allocations served from the cache and ones that went to operator new
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+struct FreeBlock {
+    FreeBlock* next;
+};
+
+struct FreeList {
+    FreeBlock* head = nullptr;
+    size_t size = 0;
+};
+
+// Trivially destructible, so it stays usable while other thread-local and static objects are destroyed
+struct ThreadCache {
+    FreeList lists[CLASSES];
+    Stats stats;
+    bool drained = false;
+};
+
+inline thread_local ThreadCache cache;
+
+// Size of the class holding `bytes`, or `bytes` itself when it is too large to be cached
+inline size_t ClassBytes(size_t bytes) noexcept {
+    if (bytes <= MIN_CLASS_BYTES) {
+        return MIN_CLASS_BYTES;
+    }
+    if (bytes > MAX_CLASS_BYTES) {
+        return bytes;
+    }
+    return size_t{1} << (64 - __builtin_clzll(bytes - 1));
+}
+
+inline size_t ClassIndex(size_t class_bytes) noexcept {
+    return static_cast<size_t>(__builtin_ctzll(class_bytes / MIN_CLASS_BYTES));
+}
+
+inline void Drain() noexcept {
+    for (FreeList& list : cache.lists) {
+        while (list.head != nullptr) {
+            ::operator delete(std::exchange(list.head, list.head->next));
+        }
+        list.size = 0;
+    }
+}
+
+// Frees the cache at thread exit. Buffers released after that go straight to operator delete.
+struct Drainer {
+    ~Drainer() {
+        Drain();
+        cache.drained = true;
+    }
+};
+
+// `bytes` must be a value returned by ClassBytes
+inline void* Allocate(size_t bytes) {
+    if (bytes <= MAX_CLASS_BYTES) {
+        FreeList& list = cache.lists[ClassIndex(bytes)];
+        if (list.head != nullptr) {
+            ++cache.stats.hits;
+            --list.size;
+            return std::exchange(list.head, list.head->next);
+        }
+    }
+    ++cache.stats.misses;
+    return ::operator new(bytes);
+}
+
+inline void Deallocate(void* buffer, size_t bytes) noexcept {
+    if (bytes > MAX_CLASS_BYTES || cache.drained) {
+        ::operator delete(buffer);
+        return;
+    }
+
+    FreeList& list = cache.lists[ClassIndex(bytes)];
+    if (list.size == BLOCKS_PER_CLASS) {
+        ::operator delete(buffer);
+        return;
+    }
+
+    thread_local Drainer drainer;
+    static_cast<void>(drainer);
+
+    list.head = new (buffer) FreeBlock{list.head};
+    ++list.size;
+}
+
+// Counters of the calling thread
+inline Stats LocalStats() noexcept { return cache.stats; }
+
+}  // namespace vector_pool
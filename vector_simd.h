@@ -0,0 +1,282 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// Vectorized scans over arrays of arithmetic elements. Kernels are written once with GCC vector extensions
+// over 64-byte blocks; the compiler lowers a block to one AVX-512 register, two AVX2 registers or four
+// SSE/NEON registers depending on the target the kernel is compiled for. On x86 every kernel is also
+// compiled for SSE4.2, AVX2 and AVX-512 and the widest one the CPU supports is picked at run time.
+namespace simd {
+
+// Blocks are passed by value only between always_inline helpers, so the ABI of doing that doesn't matter
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+template <typename T>
+inline constexpr bool IS_SUPPORTED = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+inline constexpr size_t BLOCK_BYTES = 64;
+
+template <typename T>
+struct Block {
+    typedef T Type __attribute__((vector_size(BLOCK_BYTES)));
+
+    // Lanes of comparison results are 0 or -1
+    using Mask = decltype(Type{} == Type{});
+
+    static constexpr size_t LANES = BLOCK_BYTES / sizeof(T);
+
+    [[gnu::always_inline]] static inline Type Load(const T* data) noexcept {
+        Type block;
+        std::memcpy(&block, data, sizeof(block));
+        return block;
+    }
+
+    [[gnu::always_inline]] static inline void Store(T* data, const Type& block) noexcept {
+        std::memcpy(data, &block, sizeof(block));
+    }
+
+    [[gnu::always_inline]] static inline Type Splat(T value) noexcept {
+        Type block;
+        for (size_t i = 0; i < LANES; ++i) {
+            block[i] = value;
+        }
+        return block;
+    }
+
+    [[gnu::always_inline]] static inline bool Any(const Mask& mask) noexcept {
+        uint64_t words[BLOCK_BYTES / sizeof(uint64_t)];
+        std::memcpy(words, &mask, sizeof(words));
+        uint64_t any = 0;
+        for (uint64_t word : words) {
+            any |= word;
+        }
+        return any != 0;
+    }
+};
+
+// Returns the index of the first element equal to value, or n
+template <typename T>
+struct FindKernel {
+    [[gnu::always_inline]] static inline size_t Run(const T* data, size_t n, T value) noexcept {
+        using B = Block<T>;
+        const typename B::Type needle = B::Splat(value);
+
+        size_t i = 0;
+        for (; i + B::LANES <= n; i += B::LANES) {
+            if (B::Any(B::Load(data + i) == needle)) {
+                break;
+            }
+        }
+        for (; i < n; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return n;
+    }
+};
+
+template <typename T>
+struct CountKernel {
+    [[gnu::always_inline]] static inline size_t Run(const T* data, size_t n, T value) noexcept {
+        using B = Block<T>;
+        using Lane = std::remove_reference_t<decltype(typename B::Mask{}[0])>;
+        // Lanes count matches in their own width, so they are flushed before they can overflow
+        constexpr size_t MAX_BLOCKS = std::numeric_limits<Lane>::max();
+
+        const typename B::Type needle = B::Splat(value);
+        size_t count = 0;
+        size_t i = 0;
+        while (i + B::LANES <= n) {
+            const size_t blocks = std::min((n - i) / B::LANES, MAX_BLOCKS);
+            typename B::Mask counts{};
+            for (size_t b = 0; b < blocks; ++b, i += B::LANES) {
+                counts -= B::Load(data + i) == needle;
+            }
+            for (size_t lane = 0; lane < B::LANES; ++lane) {
+                count += static_cast<size_t>(counts[lane]);
+            }
+        }
+        for (; i < n; ++i) {
+            count += data[i] == value;
+        }
+        return count;
+    }
+};
+
+template <typename T>
+struct FillKernel {
+    [[gnu::always_inline]] static inline void Run(T* data, size_t n, T value) noexcept {
+        using B = Block<T>;
+        const typename B::Type block = B::Splat(value);
+
+        size_t i = 0;
+        for (; i + B::LANES <= n; i += B::LANES) {
+            B::Store(data + i, block);
+        }
+        for (; i < n; ++i) {
+            data[i] = value;
+        }
+    }
+};
+
+// Adds lane by lane, so floating point sums are rounded differently from a sequential loop. Integers are
+// added as unsigned and wrap around like a sequential sum converted to T.
+template <typename T, bool = std::is_integral_v<T>>
+struct SumType {
+    using Type = T;
+};
+
+template <typename T>
+struct SumType<T, true> {
+    using Type = std::make_unsigned_t<T>;
+};
+
+template <typename T>
+struct SumKernel {
+    using Sum = typename SumType<T>::Type;
+
+    [[gnu::always_inline]] static inline T Run(const T* data, size_t n) noexcept {
+        using B = Block<Sum>;
+        const Sum* values = reinterpret_cast<const Sum*>(data);
+        typename B::Type sums{};
+
+        size_t i = 0;
+        for (; i + B::LANES <= n; i += B::LANES) {
+            sums += B::Load(values + i);
+        }
+        Sum sum{};
+        for (size_t lane = 0; lane < B::LANES; ++lane) {
+            sum += sums[lane];
+        }
+        for (; i < n; ++i) {
+            sum += values[i];
+        }
+        return static_cast<T>(sum);
+    }
+};
+
+// Smallest element of a non-empty array (largest when Greatest is set). The result is unspecified if the
+// array holds NaNs.
+template <typename T, bool Greatest>
+struct MinMaxKernel {
+    [[gnu::always_inline]] static inline T Run(const T* data, size_t n) noexcept {
+        using B = Block<T>;
+        T best = data[0];
+
+        size_t i = 0;
+        if (n >= B::LANES) {
+            typename B::Type bests = B::Load(data);
+            for (i = B::LANES; i + B::LANES <= n; i += B::LANES) {
+                const typename B::Type block = B::Load(data + i);
+                bests = Greatest ? (block > bests ? block : bests) : (block < bests ? block : bests);
+            }
+            for (size_t lane = 0; lane < B::LANES; ++lane) {
+                best = Better(bests[lane], best) ? bests[lane] : best;
+            }
+        }
+        for (; i < n; ++i) {
+            best = Better(data[i], best) ? data[i] : best;
+        }
+        return best;
+    }
+
+    [[gnu::always_inline]] static inline bool Better(T lhs, T rhs) noexcept { return Greatest ? rhs < lhs : lhs < rhs; }
+};
+
+#if defined(__x86_64__) || defined(__i386__)
+
+enum class Isa { BASELINE, SSE4_2, AVX2, AVX512 };
+
+inline Isa DetectIsa() noexcept {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) {
+        return Isa::AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return Isa::AVX2;
+    }
+    if (__builtin_cpu_supports("sse4.2")) {
+        return Isa::SSE4_2;
+    }
+    return Isa::BASELINE;
+}
+
+inline Isa SelectedIsa() noexcept {
+    static const Isa isa = DetectIsa();
+    return isa;
+}
+
+template <typename Kernel, typename... Args>
+[[gnu::target("sse4.2")]] auto RunSse42(Args... args) noexcept {
+    return Kernel::Run(args...);
+}
+
+template <typename Kernel, typename... Args>
+[[gnu::target("avx2")]] auto RunAvx2(Args... args) noexcept {
+    return Kernel::Run(args...);
+}
+
+template <typename Kernel, typename... Args>
+[[gnu::target("avx512f,avx512bw")]] auto RunAvx512(Args... args) noexcept {
+    return Kernel::Run(args...);
+}
+
+#endif
+
+// Runs the kernel compiled for the widest instruction set available
+template <typename Kernel, typename... Args>
+auto Run(Args... args) noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+    switch (SelectedIsa()) {
+        case Isa::AVX512:
+            return RunAvx512<Kernel>(args...);
+        case Isa::AVX2:
+            return RunAvx2<Kernel>(args...);
+        case Isa::SSE4_2:
+            return RunSse42<Kernel>(args...);
+        case Isa::BASELINE:
+            break;
+    }
+#endif
+    return Kernel::Run(args...);
+}
+
+template <typename T>
+size_t Find(const T* data, size_t n, T value) noexcept {
+    return Run<FindKernel<T>>(data, n, value);
+}
+
+template <typename T>
+size_t Count(const T* data, size_t n, T value) noexcept {
+    return Run<CountKernel<T>>(data, n, value);
+}
+
+template <typename T>
+void Fill(T* data, size_t n, T value) noexcept {
+    Run<FillKernel<T>>(data, n, value);
+}
+
+template <typename T>
+T Sum(const T* data, size_t n) noexcept {
+    return Run<SumKernel<T>>(data, n);
+}
+
+template <typename T>
+T Min(const T* data, size_t n) noexcept {
+    return Run<MinMaxKernel<T, false>>(data, n);
+}
+
+template <typename T>
+T Max(const T* data, size_t n) noexcept {
+    return Run<MinMaxKernel<T, true>>(data, n);
+}
+
+#pragma GCC diagnostic pop
+
+}  // namespace simd
@@ -0,0 +1,63 @@
+#pragma once
+#include <cstddef>
+
+// Per-element-type counters for RawMemory allocations and element relocation, compiled in only when
+// VECTOR_ENABLE_STATS is defined (consistently across translation units). Otherwise the hooks expand to
+// nothing.
+#ifdef VECTOR_ENABLE_STATS
+
+#include <atomic>
+#include <type_traits>
+
+template <typename T>
+struct VectorStats {
+    static void OnAllocate(size_t capacity) noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        bytes_allocated.fetch_add(capacity * sizeof(T), std::memory_order_relaxed);
+
+        size_t peak = peak_capacity.load(std::memory_order_relaxed);
+        while (capacity > peak && !peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+
+    static void OnDeallocate() noexcept { deallocations.fetch_add(1, std::memory_order_relaxed); }
+
+    static void OnReallocate() noexcept { reallocations.fetch_add(1, std::memory_order_relaxed); }
+
+    static void OnRelocate(size_t n) noexcept { relocated.fetch_add(n, std::memory_order_relaxed); }
+
+    static void OnCopy(size_t n) noexcept { copied.fetch_add(n, std::memory_order_relaxed); }
+
+    static void Reset() noexcept {
+        allocations = 0;
+        deallocations = 0;
+        bytes_allocated = 0;
+        reallocations = 0;
+        relocated = 0;
+        copied = 0;
+        peak_capacity = 0;
+    }
+
+    static inline std::atomic<size_t> allocations{0};
+    static inline std::atomic<size_t> deallocations{0};
+    static inline std::atomic<size_t> bytes_allocated{0};
+    // Buffer replacements that had to transfer existing elements
+    static inline std::atomic<size_t> reallocations{0};
+    // Elements moved or memcpy'd into a new buffer, and elements that had to be copied instead
+    static inline std::atomic<size_t> relocated{0};
+    static inline std::atomic<size_t> copied{0};
+    static inline std::atomic<size_t> peak_capacity{0};
+};
+
+// Counters aren't updated while a constexpr Vector is evaluated at compile time
+#if __cplusplus >= 202002L
+#define VECTOR_STATS(T, hook) (std::is_constant_evaluated() ? static_cast<void>(0) : VectorStats<T>::hook)
+#else
+#define VECTOR_STATS(T, hook) VectorStats<T>::hook
+#endif
+
+#else
+
+#define VECTOR_STATS(T, hook) static_cast<void>(0)
+
+#endif